@@ -0,0 +1,128 @@
+/*
+    SPDX-FileCopyrightText: 2021 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "../src/qmlcontrols/kquickcontrolsaddons/columnproxymodel.h"
+#include <QAbstractTableModel>
+#include <QCoreApplication>
+#include <QTest>
+
+static const int s_rowCount = 100000;
+
+// a big model computing its data, so that only the proxy is measured
+class TableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : m_rowCount;
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : 4;
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
+    {
+        return role == Qt::DisplayRole ? QVariant(index.row() * 4 + index.column()) : QVariant();
+    }
+
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override
+    {
+        beginRemoveRows(parent, row, row + count - 1);
+        m_rowCount -= count;
+        endRemoveRows();
+        return true;
+    }
+
+    void changeRow(int row)
+    {
+        Q_EMIT dataChanged(index(row, 0), index(row, 3), {Qt::DisplayRole});
+    }
+
+private:
+    int m_rowCount = s_rowCount;
+};
+
+class ColumnProxyModelBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void benchmarkData();
+    void benchmarkSetColumn();
+    void benchmarkDataChanged();
+    void benchmarkRemoveRows();
+};
+
+void ColumnProxyModelBenchmark::benchmarkData()
+{
+    TableModel model;
+    ColumnProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setColumn(2);
+
+    QBENCHMARK {
+        for (int row = 0; row < s_rowCount; ++row) {
+            proxy.data(proxy.index(row));
+        }
+    }
+}
+
+void ColumnProxyModelBenchmark::benchmarkSetColumn()
+{
+    TableModel model;
+    ColumnProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    int column = 0;
+    QBENCHMARK {
+        column = (column + 1) % 4;
+        proxy.setColumn(column);
+    }
+}
+
+void ColumnProxyModelBenchmark::benchmarkDataChanged()
+{
+    TableModel model;
+    ColumnProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setColumn(1);
+
+    int changes = 0;
+    connect(&proxy, &QAbstractItemModel::dataChanged, this, [&changes]() {
+        ++changes;
+    });
+
+    QBENCHMARK {
+        for (int row = 0; row < s_rowCount; ++row) {
+            model.changeRow(row);
+        }
+        // the changes are announced once the event loop runs
+        QCoreApplication::processEvents();
+    }
+    QVERIFY(changes > 0);
+}
+
+void ColumnProxyModelBenchmark::benchmarkRemoveRows()
+{
+    TableModel model;
+    ColumnProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < 1000; ++i) {
+            model.removeRow(0);
+        }
+    }
+    QCOMPARE(proxy.rowCount(), s_rowCount - 1000);
+}
+
+QTEST_MAIN(ColumnProxyModelBenchmark)
+
+#include "columnproxymodelbenchmark.moc"
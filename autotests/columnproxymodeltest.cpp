@@ -10,6 +10,7 @@
 #include <QTest>
 #include <QSignalSpy>
 #include <QStandardItemModel>
+#include <QStringListModel>
 
 QTEST_MAIN(ColumnProxyModelTest)
 
@@ -76,3 +77,184 @@ void ColumnProxyModelTest::testSet()
     listify->setData(changeIndex, QVariant::fromValue(newString), Qt::DisplayRole);
     QCOMPARE(changeIndex.data(Qt::DisplayRole).toString(), newString);
 }
+
+void ColumnProxyModelTest::testColumn()
+{
+    QStandardItemModel m(3, 2);
+    for (int row = 0; row < 3; ++row) {
+        m.setItem(row, 0, new QStandardItem(QStringLiteral("first %1").arg(row)));
+        m.setItem(row, 1, new QStandardItem(QStringLiteral("second %1").arg(row)));
+    }
+
+    ColumnProxyModel listify;
+    new QAbstractItemModelTester(&listify, &listify);
+    listify.setSourceModel(&m);
+    QCOMPARE(listify.index(2).data().toString(), QStringLiteral("first 2"));
+
+    QSignalSpy resetSpy(&listify, &QAbstractItemModel::modelReset);
+    QSignalSpy dataSpy(&listify, &QAbstractItemModel::dataChanged);
+    QSignalSpy columnSpy(&listify, &ColumnProxyModel::columnChanged);
+    listify.setColumn(1);
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(columnSpy.count(), 1);
+    QCOMPARE(dataSpy.count(), 1);
+    QCOMPARE(dataSpy.at(0).at(0).toModelIndex(), listify.index(0));
+    QCOMPARE(dataSpy.at(0).at(1).toModelIndex(), listify.index(2));
+    QCOMPARE(listify.index(2).data().toString(), QStringLiteral("second 2"));
+
+    listify.setColumn(1);
+    QCOMPARE(columnSpy.count(), 1);
+    QCOMPARE(dataSpy.count(), 1);
+}
+
+void ColumnProxyModelTest::testDataChanged()
+{
+    QStandardItemModel m(3, 2);
+    for (int row = 0; row < 3; ++row) {
+        m.setItem(row, 0, new QStandardItem(QStringLiteral("first %1").arg(row)));
+        m.setItem(row, 1, new QStandardItem(QStringLiteral("second %1").arg(row)));
+    }
+
+    ColumnProxyModel listify;
+    new QAbstractItemModelTester(&listify, &listify);
+    listify.setSourceModel(&m);
+    listify.setColumn(1);
+
+    QSignalSpy dataSpy(&listify, &QAbstractItemModel::dataChanged);
+
+    // other columns aren't shown
+    m.item(1, 0)->setText(QStringLiteral("changed"));
+    QCOMPARE(dataSpy.count(), 0);
+
+    m.item(1, 1)->setData(QStringLiteral("changed"), Qt::ToolTipRole);
+    QCOMPARE(dataSpy.count(), 0);
+    QTRY_COMPARE(dataSpy.count(), 1);
+    QCOMPARE(dataSpy.at(0).at(0).toModelIndex(), listify.index(1));
+    QCOMPARE(dataSpy.at(0).at(1).toModelIndex(), listify.index(1));
+    QCOMPARE(dataSpy.at(0).at(2).value<QVector<int>>(), QVector<int>{Qt::ToolTipRole});
+}
+
+void ColumnProxyModelTest::testWatchedRoles()
+{
+    QStandardItemModel m;
+    m.setItemRoleNames({{Qt::DisplayRole, "display"}, {Qt::ToolTipRole, "toolTip"}, {Qt::DecorationRole, "decoration"}});
+    for (int row = 0; row < 3; ++row) {
+        m.appendRow(new QStandardItem(QStringLiteral("item %1").arg(row)));
+    }
+
+    ColumnProxyModel listify;
+    new QAbstractItemModelTester(&listify, &listify);
+    listify.setSourceModel(&m);
+    listify.setWatchedRoles({QStringLiteral("display"), QStringLiteral("toolTip")});
+
+    QSignalSpy dataSpy(&listify, &QAbstractItemModel::dataChanged);
+
+    // unwatched roles aren't announced
+    m.item(0)->setData(QStringLiteral("icon"), Qt::DecorationRole);
+    QCoreApplication::processEvents();
+    QCOMPARE(dataSpy.count(), 0);
+
+    m.item(0)->setData(QStringLiteral("tip"), Qt::ToolTipRole);
+    QTRY_COMPARE(dataSpy.count(), 1);
+    QCOMPARE(dataSpy.at(0).at(2).value<QVector<int>>(), QVector<int>{Qt::ToolTipRole});
+
+    // a change of all the roles is one of the watched ones
+    Q_EMIT m.dataChanged(m.index(1, 0), m.index(1, 0));
+    QTRY_COMPARE(dataSpy.count(), 2);
+    QCOMPARE(dataSpy.at(1).at(2).value<QVector<int>>(), (QVector<int>{Qt::DisplayRole, Qt::ToolTipRole}));
+
+    // pending changes are announced with the filter they were gathered with
+    m.item(2)->setData(QStringLiteral("other tip"), Qt::ToolTipRole);
+    listify.setWatchedRoles({QStringLiteral("decoration")});
+    QCOMPARE(dataSpy.count(), 3);
+    QCOMPARE(dataSpy.at(2).at(2).value<QVector<int>>(), QVector<int>{Qt::ToolTipRole});
+
+    // watched roles unknown to the source model let nothing through
+    listify.setWatchedRoles({QStringLiteral("unknown")});
+    m.item(0)->setData(QStringLiteral("changed"), Qt::DisplayRole);
+    Q_EMIT m.dataChanged(m.index(1, 0), m.index(1, 0));
+    listify.setColumn(1);
+    listify.setColumn(0);
+    QCoreApplication::processEvents();
+    QCOMPARE(dataSpy.count(), 3);
+}
+
+void ColumnProxyModelTest::testCoalescedDataChanged()
+{
+    QStandardItemModel m;
+    for (int row = 0; row < 10; ++row) {
+        m.appendRow(new QStandardItem(QStringLiteral("item %1").arg(row)));
+    }
+
+    ColumnProxyModel listify;
+    new QAbstractItemModelTester(&listify, &listify);
+    listify.setSourceModel(&m);
+
+    QSignalSpy dataSpy(&listify, &QAbstractItemModel::dataChanged);
+    for (int row = 2; row < 6; ++row) {
+        m.item(row)->setData(QStringLiteral("tip"), Qt::ToolTipRole);
+    }
+    m.item(8)->setData(QStringLiteral("tip"), Qt::ToolTipRole);
+
+    QTRY_COMPARE(dataSpy.count(), 2);
+    QCOMPARE(dataSpy.at(0).at(0).toModelIndex(), listify.index(2));
+    QCOMPARE(dataSpy.at(0).at(1).toModelIndex(), listify.index(5));
+    QCOMPARE(dataSpy.at(1).at(0).toModelIndex(), listify.index(8));
+    QCOMPARE(dataSpy.at(1).at(1).toModelIndex(), listify.index(8));
+
+    // pending changes are announced before the rows move
+    m.item(0)->setData(QStringLiteral("tip"), Qt::ToolTipRole);
+    m.removeRow(1);
+    QCOMPARE(dataSpy.count(), 3);
+    QCOMPARE(dataSpy.at(2).at(0).toModelIndex().row(), 0);
+}
+
+void ColumnProxyModelTest::testMoveRows()
+{
+    QStringListModel m({QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c"), QStringLiteral("d")});
+
+    ColumnProxyModel listify;
+    new QAbstractItemModelTester(&listify, &listify);
+    listify.setSourceModel(&m);
+    QPersistentModelIndex first(listify.index(0));
+
+    QSignalSpy movedSpy(&listify, &QAbstractItemModel::rowsMoved);
+    QSignalSpy removedSpy(&listify, &QAbstractItemModel::rowsRemoved);
+    QVERIFY(m.moveRow(QModelIndex(), 0, QModelIndex(), 3));
+    QCOMPARE(movedSpy.count(), 1);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(listify.index(2).data().toString(), QStringLiteral("a"));
+    QCOMPARE(first.row(), 2);
+
+    QVERIFY(m.removeRows(1, 2));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(listify.rowCount(), 2);
+    QVERIFY(!first.isValid());
+}
+
+void ColumnProxyModelTest::testRemoveRoot()
+{
+    QStandardItemModel m;
+    QStandardItem* parent = new QStandardItem(QStringLiteral("parent"));
+    QStandardItem* item = new QStandardItem(QStringLiteral("item"));
+    m.appendRow(parent);
+    m.appendRow(new QStandardItem(QStringLiteral("other")));
+    parent->appendRow(item);
+    item->appendRow(new QStandardItem(QStringLiteral("child")));
+
+    ColumnProxyModel listify;
+    new QAbstractItemModelTester(&listify, &listify);
+    listify.setRootIndex(item->index());
+    QCOMPARE(listify.rowCount(), 1);
+
+    QSignalSpy rootSpy(&listify, &ColumnProxyModel::rootIndexChanged);
+    QSignalSpy insertedSpy(&listify, &QAbstractItemModel::rowsInserted);
+    m.removeRow(0);
+    QCOMPARE(rootSpy.count(), 1);
+    QCOMPARE(listify.rowCount(), 0);
+
+    // the top level items aren't shown in place of the removed root
+    m.appendRow(new QStandardItem(QStringLiteral("new")));
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(listify.rowCount(), 0);
+}
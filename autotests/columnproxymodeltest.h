@@ -16,6 +16,12 @@ class ColumnProxyModelTest : public QObject
     private Q_SLOTS:
         void testInit();
         void testSet();
+        void testColumn();
+        void testDataChanged();
+        void testWatchedRoles();
+        void testCoalescedDataChanged();
+        void testMoveRows();
+        void testRemoveRoot();
 };
 
 #endif
@@ -0,0 +1,101 @@
+/*
+    SPDX-FileCopyrightText: 2021 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <configmodule.h>
+
+#include <KAboutData>
+#include <QDir>
+#include <QFileInfo>
+#include <QQmlAbstractUrlInterceptor>
+#include <QQmlEngine>
+#include <QQmlFileSelector>
+#include <QQuickItem>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <memory>
+#include <vector>
+
+static const QString s_componentName = QStringLiteral("kcm_configmoduletest");
+
+class ConfigModuleTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void sharedFileSelector();
+
+private:
+    void writeFile(const QString &fileName, const QByteArray &contents);
+    QString m_packagePath;
+};
+
+void ConfigModuleTest::writeFile(const QString &fileName, const QByteArray &contents)
+{
+    const QString filePath = m_packagePath + QLatin1Char('/') + fileName;
+    QVERIFY(QDir().mkpath(QFileInfo(filePath).absolutePath()));
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(contents);
+}
+
+void ConfigModuleTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_packagePath = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+        + QStringLiteral("/kpackage/kcms/") + s_componentName;
+    QDir(m_packagePath).removeRecursively();
+
+    writeFile(QStringLiteral("metadata.json"), "{ \"KPlugin\": { \"Id\": \"kcm_configmoduletest\" } }");
+    writeFile(QStringLiteral("contents/ui/main.qml"), "import QtQuick 2.0\nItem { objectName: \"default\" }\n");
+    writeFile(QStringLiteral("contents/ui/+configmoduletest/main.qml"), "import QtQuick 2.0\nItem { objectName: \"selected\" }\n");
+}
+
+void ConfigModuleTest::cleanupTestCase()
+{
+    QDir(m_packagePath).removeRecursively();
+}
+
+void ConfigModuleTest::sharedFileSelector()
+{
+    KQuickAddons::ConfigModule::setExtraFileSelectors({QStringLiteral("configmoduletest")});
+    QCOMPARE(KQuickAddons::ConfigModule::extraFileSelectors(), QStringList{QStringLiteral("configmoduletest")});
+
+    std::vector<std::unique_ptr<KQuickAddons::ConfigModule>> modules;
+    QQmlEngine *engine = nullptr;
+    QQmlAbstractUrlInterceptor *interceptor = nullptr;
+    for (int i = 0; i < 10; ++i) {
+        std::unique_ptr<KQuickAddons::ConfigModule> module(
+            new KQuickAddons::ConfigModule(new KAboutData(s_componentName, QStringLiteral("Test"), QStringLiteral("1.0"))));
+        QQuickItem *item = module->mainUi();
+        QVERIFY2(item, qPrintable(module->errorString()));
+        QCOMPARE(item->objectName(), QStringLiteral("selected"));
+
+        // the modules all use the shared engine
+        if (!engine) {
+            engine = module->engine();
+            interceptor = engine->urlInterceptor();
+        }
+        QCOMPARE(module->engine(), engine);
+
+        // urls keep going through a single interceptor, however many modules are opened.
+        // With Qt 5 an engine has only one, a new QQmlFileSelector replaces the previous one
+        QCOMPARE(engine->findChildren<QQmlFileSelector *>().count(), 1);
+        QCOMPARE(engine->urlInterceptor(), interceptor);
+
+        // and it still resolves the selected variant
+        const QUrl mainUrl = QUrl::fromLocalFile(m_packagePath + QStringLiteral("/contents/ui/main.qml"));
+        QCOMPARE(interceptor->intercept(mainUrl, QQmlAbstractUrlInterceptor::QmlFile),
+                 QUrl::fromLocalFile(m_packagePath + QStringLiteral("/contents/ui/+configmoduletest/main.qml")));
+        modules.push_back(std::move(module));
+    }
+}
+
+QTEST_MAIN(ConfigModuleTest)
+
+#include "configmoduletest.moc"
@@ -0,0 +1,154 @@
+/*
+    SPDX-FileCopyrightText: 2021 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <KCoreConfigSkeleton>
+#include <KSharedConfig>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <kdeclarative/configpropertymap.h>
+
+class CountingSkeleton : public KCoreConfigSkeleton
+{
+public:
+    explicit CountingSkeleton(KSharedConfig::Ptr config)
+        : KCoreConfigSkeleton(config)
+    {
+        setCurrentGroup(QStringLiteral("General"));
+        addItemInt(QStringLiteral("Volume"), m_volume, 50);
+        addItemString(QStringLiteral("Name"), m_name, QStringLiteral("default"));
+    }
+
+    int saveCount = 0;
+
+protected:
+    bool usrSave() override
+    {
+        ++saveCount;
+        return KCoreConfigSkeleton::usrSave();
+    }
+
+private:
+    int m_volume = 0;
+    QString m_name;
+};
+
+class ConfigPropertyMapTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void testAutosave();
+    void testCoalescedWrites();
+    void testFlush();
+    void testLazyDefaults();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_configPath;
+    KSharedConfig::Ptr m_config;
+};
+
+void ConfigPropertyMapTest::init()
+{
+    QVERIFY(m_dir.isValid());
+    // KSharedConfig keeps the configs it opened, each test gets its own
+    m_configPath = m_dir.filePath(QString::fromLatin1(QTest::currentTestFunction()) + QStringLiteral("rc"));
+    QFile::remove(m_configPath);
+    m_config = KSharedConfig::openConfig(m_configPath, KConfig::SimpleConfig);
+}
+
+void ConfigPropertyMapTest::testAutosave()
+{
+    CountingSkeleton skeleton(m_config);
+    KDeclarative::ConfigPropertyMap map(&skeleton);
+
+    for (int i = 1; i <= 5; ++i) {
+        map.insert(QStringLiteral("Volume"), i);
+        Q_EMIT map.valueChanged(QStringLiteral("Volume"), i);
+    }
+
+    // without a delay every change is written on its own
+    QCOMPARE(skeleton.saveCount, 5);
+    QCOMPARE(m_config->group("General").readEntry("Volume", 0), 5);
+}
+
+void ConfigPropertyMapTest::testCoalescedWrites()
+{
+    CountingSkeleton skeleton(m_config);
+    KDeclarative::ConfigPropertyMap map(&skeleton);
+    map.setAutosaveDelay(20);
+    QCOMPARE(map.autosaveDelay(), 20);
+
+    for (int i = 1; i <= 5; ++i) {
+        map.insert(QStringLiteral("Volume"), i);
+        Q_EMIT map.valueChanged(QStringLiteral("Volume"), i);
+    }
+    map.insert(QStringLiteral("Name"), QStringLiteral("changed"));
+    Q_EMIT map.valueChanged(QStringLiteral("Name"), QStringLiteral("changed"));
+
+    QCOMPARE(skeleton.saveCount, 0);
+    QTRY_COMPARE(skeleton.saveCount, 1);
+
+    KConfig reread(m_configPath, KConfig::SimpleConfig);
+    QCOMPARE(reread.group("General").readEntry("Volume", 0), 5);
+    QCOMPARE(reread.group("General").readEntry("Name", QString()), QStringLiteral("changed"));
+
+    // a later change must still reach the disk
+    map.insert(QStringLiteral("Volume"), 7);
+    Q_EMIT map.valueChanged(QStringLiteral("Volume"), 7);
+    QTRY_COMPARE(skeleton.saveCount, 2);
+    reread.reparseConfiguration();
+    QCOMPARE(reread.group("General").readEntry("Volume", 0), 7);
+}
+
+void ConfigPropertyMapTest::testFlush()
+{
+    CountingSkeleton skeleton(m_config);
+    KDeclarative::ConfigPropertyMap map(&skeleton);
+    map.setAutosaveDelay(60000);
+
+    map.insert(QStringLiteral("Volume"), 3);
+    Q_EMIT map.valueChanged(QStringLiteral("Volume"), 3);
+    map.insert(QStringLiteral("Volume"), 4);
+    Q_EMIT map.valueChanged(QStringLiteral("Volume"), 4);
+    QCOMPARE(skeleton.saveCount, 0);
+
+    map.flush();
+    QCOMPARE(skeleton.saveCount, 1);
+    QCOMPARE(m_config->group("General").readEntry("Volume", 0), 4);
+
+    // nothing pending, nothing written
+    map.flush();
+    QCOMPARE(skeleton.saveCount, 1);
+}
+
+void ConfigPropertyMapTest::testLazyDefaults()
+{
+    CountingSkeleton skeleton(m_config);
+    KDeclarative::ConfigPropertyMap map(&skeleton,
+                                        KDeclarative::ConfigPropertyMap::LazyDefaults | KDeclarative::ConfigPropertyMap::NotifyChangedValuesOnly);
+
+    QVERIFY(map.contains(QStringLiteral("Volume")));
+    QVERIFY(!map.contains(QStringLiteral("VolumeDefault")));
+    QCOMPARE(map.defaultValue(QStringLiteral("Volume")).toInt(), 50);
+    QVERIFY(!map.defaultValue(QStringLiteral("DoesNotExist")).isValid());
+
+    QSignalSpy spy(&map, &KDeclarative::ConfigPropertyMap::valueChanged);
+    skeleton.findItem(QStringLiteral("Volume"))->setProperty(12);
+    Q_EMIT skeleton.configChanged();
+
+    // only the value which actually changed is notified
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toString(), QStringLiteral("Volume"));
+    QCOMPARE(map.value(QStringLiteral("Volume")).toInt(), 12);
+}
+
+QTEST_MAIN(ConfigPropertyMapTest)
+
+#include "configpropertymaptest.moc"
@@ -0,0 +1,148 @@
+/*
+    SPDX-FileCopyrightText: 2021 agent <agent@local>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <imagetexturescache.h>
+#include <managedtexturenode.h>
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QTest>
+
+#include <memory>
+#include <vector>
+
+static const int s_imageCount = 8;
+
+// Loads a different, shared, image from the cache on each frame
+class TextureItem : public QQuickItem
+{
+public:
+    TextureItem(ImageTexturesCache *cache, const QVector<QImage> &images, QQuickItem *parent)
+        : QQuickItem(parent)
+        , m_cache(cache)
+        , m_images(images)
+    {
+        setFlag(ItemHasContents, true);
+        setSize(QSizeF(32, 32));
+    }
+
+    QAtomicInt frames;
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *node, UpdatePaintNodeData *) override
+    {
+        ManagedTextureNode *mNode = static_cast<ManagedTextureNode *>(node);
+        if (!mNode) {
+            mNode = new ManagedTextureNode;
+        }
+        const int frame = frames.fetchAndAddOrdered(1);
+        mNode->setTexture(m_cache->loadTexture(window(), m_images.at(frame % m_images.count())));
+        mNode->setRect(boundingRect());
+        // keep the render thread busy
+        QMetaObject::invokeMethod(this, &QQuickItem::update, Qt::QueuedConnection);
+        return mNode;
+    }
+
+private:
+    ImageTexturesCache *m_cache;
+    const QVector<QImage> m_images;
+};
+
+class ImageTexturesCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void multipleWindows();
+    void retention();
+
+private:
+    QVector<QImage> createImages() const;
+};
+
+QVector<QImage> ImageTexturesCacheTest::createImages() const
+{
+    QVector<QImage> images;
+    for (int i = 0; i < s_imageCount; ++i) {
+        QImage image(32, 32, QImage::Format_ARGB32_Premultiplied);
+        image.fill(QColor::fromHsv(i * 360 / s_imageCount, 255, 255));
+        images << image;
+    }
+    return images;
+}
+
+void ImageTexturesCacheTest::multipleWindows()
+{
+    ImageTexturesCache cache;
+    const QVector<QImage> images = createImages();
+
+    std::vector<std::unique_ptr<QQuickWindow>> windows;
+    QVector<TextureItem *> items;
+    for (int i = 0; i < 4; ++i) {
+        std::unique_ptr<QQuickWindow> window(new QQuickWindow);
+        window->resize(100, 100);
+        window->setPosition(i * 110, 0);
+        for (int j = 0; j < 4; ++j) {
+            TextureItem *item = new TextureItem(&cache, images, window->contentItem());
+            item->setPosition(QPointF(j * 20, j * 20));
+            items << item;
+        }
+        window->show();
+        windows.push_back(std::move(window));
+    }
+
+    for (const auto &window : windows) {
+        QVERIFY(QTest::qWaitForWindowExposed(window.get()));
+    }
+
+    for (TextureItem *item : qAsConst(items)) {
+        QTRY_VERIFY(item->frames.loadAcquire() > s_imageCount);
+    }
+
+    // textures get released while the other windows keep rendering
+    for (auto &window : windows) {
+        window.reset();
+        QTest::qWait(50);
+    }
+}
+
+void ImageTexturesCacheTest::retention()
+{
+    const qint64 textureBytes = 32 * 32 * 4;
+    ImageTexturesCache cache;
+    cache.setRetentionBudget(2 * textureBytes);
+    QCOMPARE(cache.retentionBudget(), 2 * textureBytes);
+
+    QQuickWindow window;
+    window.resize(100, 100);
+    TextureItem *item = new TextureItem(&cache, createImages(), window.contentItem());
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    // cycling through more images than the budget allows evicts the oldest ones
+    QTRY_VERIFY(item->frames.loadAcquire() > 2 * s_imageCount);
+    ImageTexturesCache::Statistics statistics = cache.statistics(&window);
+    QVERIFY(statistics.evictions > 0);
+    QVERIFY(statistics.retainedBytes <= 2 * textureBytes);
+    QVERIFY(statistics.uploads >= statistics.misses);
+
+    // with enough room every image stays uploaded
+    cache.setRetentionBudget(s_imageCount * textureBytes);
+    QTRY_COMPARE(cache.statistics(&window).retainedTextures, s_imageCount);
+    cache.resetStatistics();
+    const int frames = item->frames.loadAcquire();
+    QTRY_VERIFY(item->frames.loadAcquire() > frames + 2 * s_imageCount);
+    statistics = cache.statistics();
+    QVERIFY(statistics.hits > 0);
+    QCOMPARE(statistics.misses, quint64(0));
+    QCOMPARE(statistics.retainedBytes, s_imageCount * textureBytes);
+}
+
+QTEST_MAIN(ImageTexturesCacheTest)
+
+#include "imagetexturescachetest.moc"
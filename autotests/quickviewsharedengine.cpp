@@ -14,8 +14,11 @@
 #include "util.h"
 #include <QWindow>
 #include <QDebug>
+#include <QFile>
 #include <QQmlEngine>
 #include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
 
 class QuickViewSharedEngineTest : public QQmlDataTest
 {
@@ -27,6 +30,9 @@ private Q_SLOTS:
     void resizemodeitem();
     void errors();
     void engine();
+    void clone();
+    void deferredLoading();
+    void initialPropertiesWhileLoading();
 };
 
 
@@ -182,6 +188,104 @@ void QuickViewSharedEngineTest::engine()
     QCOMPARE(engineDestroyedSpy.count(), 1);
 }
 
+void QuickViewSharedEngineTest::clone()
+{
+    KQuickAddons::QuickViewSharedEngine *view = new KQuickAddons::QuickViewSharedEngine();
+    view->setResizeMode(KQuickAddons::QuickViewSharedEngine::SizeViewToRootObject);
+    view->setSource(testFileUrl("resizemodeitem.qml"));
+    QVERIFY(view->rootObject());
+
+    KQuickAddons::QuickViewSharedEngine *view2 = view->clone();
+    QSignalSpy statusSpy(view2, &KQuickAddons::QuickViewSharedEngine::statusChanged);
+    QCOMPARE(view2->engine(), view->engine());
+    QCOMPARE(view2->source(), view->source());
+    QCOMPARE(view2->resizeMode(), view->resizeMode());
+    QCOMPARE(view2->status(), QQmlComponent::Ready);
+
+    // a new instance of the same component
+    QVERIFY(view2->rootObject());
+    QVERIFY(view2->rootObject() != view->rootObject());
+    QCOMPARE(view2->initialSize(), QSize(200, 200));
+
+    // the component was ready already, the status is announced all the same
+    QTRY_COMPARE(statusSpy.count(), 1);
+    QCOMPARE(statusSpy.first().first().value<QQmlComponent::Status>(), QQmlComponent::Ready);
+
+    // the clone keeps working once the original view is gone
+    delete view;
+    QVERIFY(view2->rootObject());
+    QCOMPARE(view2->rootObject()->width(), 200.0);
+
+    delete view2;
+}
+
+void QuickViewSharedEngineTest::deferredLoading()
+{
+    KQuickAddons::QuickViewSharedEngine *view = new KQuickAddons::QuickViewSharedEngine();
+    view->setLoadingDeferred(true);
+    view->setInitialProperties({{QStringLiteral("width"), 120}});
+    QSignalSpy sourceSpy(view, &KQuickAddons::QuickViewSharedEngine::sourceChanged);
+
+    view->setSource(testFileUrl("resizemodeitem.qml"));
+    QCOMPARE(sourceSpy.count(), 1);
+    QCOMPARE(view->source(), testFileUrl("resizemodeitem.qml"));
+    QCOMPARE(view->status(), QQmlComponent::Null);
+    QVERIFY(!view->rootObject());
+
+    view->preload();
+    QCOMPARE(view->status(), QQmlComponent::Ready);
+    QVERIFY(view->rootObject());
+    QCOMPARE(view->rootObject()->width(), 120.0);
+    delete view;
+
+    // loading happens on first expose
+    view = new KQuickAddons::QuickViewSharedEngine();
+    view->setLoadingDeferred(true);
+    view->resize(100, 100);
+    view->setSource(testFileUrl("resizemodeitem.qml"));
+    QVERIFY(!view->rootObject());
+    view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(view));
+    QVERIFY(view->rootObject());
+    QCOMPARE(view->rootObject()->width(), 100.0);
+    delete view;
+}
+
+void QuickViewSharedEngineTest::initialPropertiesWhileLoading()
+{
+    QFile file(testFile("resizemodeitem.qml"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray contents = file.readAll();
+
+    // a remote source is still loading once setSource() returns
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    connect(&server, &QTcpServer::newConnection, &server, [&server, contents]() {
+        QTcpSocket *socket = server.nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, socket, [socket, contents]() {
+            socket->readAll();
+            if (socket->property("answered").toBool()) {
+                return;
+            }
+            socket->setProperty("answered", true);
+            socket->write("HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\nContent-Length: "
+                          + QByteArray::number(contents.size()) + "\r\n\r\n" + contents);
+            socket->disconnectFromHost();
+        });
+    });
+
+    KQuickAddons::QuickViewSharedEngine *view = new KQuickAddons::QuickViewSharedEngine();
+    view->setInitialProperties({{QStringLiteral("width"), 120}});
+    view->setSource(QUrl(QStringLiteral("http://127.0.0.1:%1/resizemodeitem.qml").arg(server.serverPort())));
+    QCOMPARE(view->status(), QQmlComponent::Loading);
+
+    QTRY_COMPARE(view->status(), QQmlComponent::Ready);
+    QTRY_VERIFY(view->rootObject());
+    QCOMPARE(view->rootObject()->width(), 120.0);
+    delete view;
+}
+
 QTEST_MAIN(QuickViewSharedEngineTest)
 
 #include "quickviewsharedengine.moc"
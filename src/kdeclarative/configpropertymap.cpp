@@ -9,6 +9,8 @@
 
 #include <QJSValue>
 #include <QPointer>
+#include <QSet>
+#include <QTimer>
 #include <KCoreConfigSkeleton>
 
 #include <functional>
@@ -20,6 +22,10 @@ public:
     ConfigPropertyMapPrivate(ConfigPropertyMap *map)
         : q(map)
     {
+        saveTimer.setSingleShot(true);
+        QObject::connect(&saveTimer, &QTimer::timeout, map, [this]() {
+            writePendingValues();
+        });
     }
 
     enum LoadConfigOption {
@@ -30,19 +36,31 @@ public:
     void loadConfig(LoadConfigOption option);
     void writeConfig();
     void writeConfigValue(const QString &key, const QVariant &value);
+    void writePendingValues();
+    KConfigSkeletonItem *findItem(const QString &key);
 
     ConfigPropertyMap *q;
     QPointer<KCoreConfigSkeleton> config;
+    QTimer saveTimer;
+    // keys rather than items, the skeleton may remove its items meanwhile
+    QSet<QString> pendingKeys;
+    ConfigPropertyMap::Options options;
     bool updatingConfigValue = false;
     bool autosave = true;
     bool notify = false;
 };
 
 ConfigPropertyMap::ConfigPropertyMap(KCoreConfigSkeleton *config, QObject *parent)
+    : ConfigPropertyMap(config, NoOptions, parent)
+{
+}
+
+ConfigPropertyMap::ConfigPropertyMap(KCoreConfigSkeleton *config, Options options, QObject *parent)
     : QQmlPropertyMap(this, parent),
       d(new ConfigPropertyMapPrivate(this))
 {
     d->config = config;
+    d->options = options;
 
     // Reload the config only if the change signal has *not* been emitted by ourselves updating the config
     connect(config, &KCoreConfigSkeleton::configChanged, this, [this] () {
@@ -84,6 +102,25 @@ void ConfigPropertyMap::setNotify(bool notify)
     d->notify = notify;
 }
 
+int ConfigPropertyMap::autosaveDelay() const
+{
+    return d->saveTimer.interval();
+}
+
+void ConfigPropertyMap::setAutosaveDelay(int delay)
+{
+    d->saveTimer.setInterval(qMax(0, delay));
+    if (delay <= 0) {
+        flush();
+    }
+}
+
+void ConfigPropertyMap::flush()
+{
+    d->saveTimer.stop();
+    d->writePendingValues();
+}
+
 QVariant ConfigPropertyMap::updateValue(const QString &key, const QVariant &input)
 {
     Q_UNUSED(key);
@@ -95,7 +132,7 @@ QVariant ConfigPropertyMap::updateValue(const QString &key, const QVariant &inpu
 
 bool ConfigPropertyMap::isImmutable(const QString &key) const
 {
-    KConfigSkeletonItem *item = d->config.data()->findItem(key);
+    KConfigSkeletonItem *item = d->findItem(key);
     if (item) {
         return item->isImmutable();
     }
@@ -103,18 +140,55 @@ bool ConfigPropertyMap::isImmutable(const QString &key) const
     return false;
 }
 
+QStringList ConfigPropertyMap::immutableKeys(const QStringList &keys) const
+{
+    QStringList result;
+    for (const QString &key : keys) {
+        KConfigSkeletonItem *item = d->findItem(key);
+        if (item && item->isImmutable()) {
+            result << key;
+        }
+    }
+
+    return result;
+}
+
+ConfigPropertyMap::Options ConfigPropertyMap::options() const
+{
+    return d->options;
+}
+
+QVariant ConfigPropertyMap::defaultValue(const QString &key) const
+{
+    KConfigSkeletonItem *item = d->findItem(key);
+    if (item) {
+        return item->getDefault();
+    }
+
+    return QVariant();
+}
+
 void ConfigPropertyMapPrivate::loadConfig(ConfigPropertyMapPrivate::LoadConfigOption option)
 {
     if (!config) {
         return;
     }
 
+    const bool lazyDefaults = options & ConfigPropertyMap::LazyDefaults;
+    const bool changedOnly = option == EmitValueChanged && (options & ConfigPropertyMap::NotifyChangedValuesOnly);
+
     const auto &items = config.data()->items();
     for (KConfigSkeletonItem *item : items) {
-        q->insert(item->key() + QStringLiteral("Default"), item->getDefault());
-        q->insert(item->key(), item->property());
+        if (!lazyDefaults) {
+            q->insert(item->key() + QStringLiteral("Default"), item->getDefault());
+        }
+        const QVariant value = item->property();
+        if (changedOnly && q->contains(item->key()) && q->value(item->key()) == value) {
+            continue;
+        }
+        q->insert(item->key(), value);
         if (option == EmitValueChanged) {
-            Q_EMIT q->valueChanged(item->key(), item->property());
+            Q_EMIT q->valueChanged(item->key(), value);
         }
     }
 }
@@ -136,16 +210,21 @@ void ConfigPropertyMapPrivate::writeConfig()
         config.data()->save();
         updatingConfigValue = false;
     }
+    saveTimer.stop();
+    pendingKeys.clear();
 }
 
 void ConfigPropertyMapPrivate::writeConfigValue(const QString &key, const QVariant &value)
 {
-    KConfigSkeletonItem *item = config.data()->findItem(key);
+    KConfigSkeletonItem *item = findItem(key);
     if (item) {
         updatingConfigValue = true;
         item->setWriteFlags(notify ? KConfigBase::Notify : KConfigBase::Normal);
         item->setProperty(value);
-        if (autosave) {
+        if (autosave && saveTimer.interval() > 0) {
+            pendingKeys.insert(key);
+            saveTimer.start();
+        } else if (autosave) {
             config.data()->save();
             //why read? read will update KConfigSkeletonItem::mLoadedValue,
             //allowing a write operation to be performed next time
@@ -155,6 +234,34 @@ void ConfigPropertyMapPrivate::writeConfigValue(const QString &key, const QVaria
     }
 }
 
+KConfigSkeletonItem *ConfigPropertyMapPrivate::findItem(const QString &key)
+{
+    if (!config) {
+        return nullptr;
+    }
+
+    return config.data()->findItem(key);
+}
+
+void ConfigPropertyMapPrivate::writePendingValues()
+{
+    if (!config || !autosave || pendingKeys.isEmpty()) {
+        pendingKeys.clear();
+        return;
+    }
+
+    updatingConfigValue = true;
+    config.data()->save();
+    //only the written items need their loaded value refreshed, no need to read() the whole skeleton
+    for (const QString &key : qAsConst(pendingKeys)) {
+        if (KConfigSkeletonItem *item = findItem(key)) {
+            item->readConfig(config.data()->config());
+        }
+    }
+    updatingConfigValue = false;
+    pendingKeys.clear();
+}
+
 }
 
 #include "moc_configpropertymap.cpp"
@@ -29,7 +29,37 @@ class KDECLARATIVE_EXPORT ConfigPropertyMap : public QQmlPropertyMap
     Q_OBJECT
 
 public:
+    /**
+     * Options controlling how the map is populated from the config object
+     * @since 5.80
+     */
+    enum Option {
+        NoOptions = 0x0,
+        /**
+         * Do not insert a "<key>Default" entry for every item,
+         * use defaultValue() to compute the default of a key when needed
+         */
+        LazyDefaults = 0x1,
+        /**
+         * When the config object changes, only update the entries whose value
+         * differs and emit valueChanged() for those alone
+         */
+        NotifyChangedValuesOnly = 0x2,
+    };
+    Q_DECLARE_FLAGS(Options, Option)
+    Q_FLAG(Options)
+
     ConfigPropertyMap(KCoreConfigSkeleton *config, QObject *parent = nullptr);
+
+    /**
+     * Creates a map populated according to @p options
+     *
+     * @param config the config object providing the values
+     * @param options how entries are inserted and updated
+     * @param parent the parent object
+     * @since 5.80
+     */
+    ConfigPropertyMap(KCoreConfigSkeleton *config, Options options, QObject *parent = nullptr);
     ~ConfigPropertyMap() override;
 
     /**
@@ -64,6 +94,38 @@ public:
      */
     void setNotify(bool notify);
 
+    /**
+     * Delay in milliseconds used to coalesce autosaved writes.
+     *
+     * When greater than zero, changes made while autosave is enabled are
+     * collected and written to the configuration object in a single save once
+     * no further change has happened for the given interval.
+     * A value of 0 (the default) saves after each individual change.
+     *
+     * @return the write delay in milliseconds
+     * @see flush()
+     * @since 5.80
+     */
+    int autosaveDelay() const;
+
+    /**
+     * Sets the delay used to coalesce autosaved writes.
+     *
+     * Setting the delay to 0 writes any pending change immediately.
+     *
+     * @param delay the new write delay in milliseconds
+     * @since 5.80
+     */
+    void setAutosaveDelay(int delay);
+
+    /**
+     * Immediately writes any change still pending because of autosaveDelay().
+     *
+     * Does nothing if there are no pending changes.
+     * @since 5.80
+     */
+    Q_INVOKABLE void flush();
+
     /**
      * @brief Whether the value at the given key is immutable
      *
@@ -71,6 +133,34 @@ public:
      */
     Q_INVOKABLE bool isImmutable(const QString &key) const;
 
+    /**
+     * @brief Which of the given keys have an immutable value
+     *
+     * Equivalent to calling isImmutable() for each key, meant for
+     * UIs checking many entries at once.
+     *
+     * @return the subset of @p keys whose value is immutable
+     * @since 5.80
+     */
+    Q_INVOKABLE QStringList immutableKeys(const QStringList &keys) const;
+
+    /**
+     * @return the options the map has been created with
+     * @since 5.80
+     */
+    Options options() const;
+
+    /**
+     * @brief The default value of the given key
+     *
+     * Unlike the "<key>Default" entries, this is computed from the config object
+     * on each call and is available with the LazyDefaults option too.
+     *
+     * @return the default value, or an invalid QVariant if the key doesn't exist
+     * @since 5.80
+     */
+    Q_INVOKABLE QVariant defaultValue(const QString &key) const;
+
 protected:
     QVariant updateValue(const QString &key, const QVariant &input) override;
 private:
@@ -80,4 +170,6 @@ private:
 
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(KDeclarative::ConfigPropertyMap::Options)
+
 #endif
@@ -11,6 +11,7 @@
 #include <QQmlContext>
 #include <QQuickItem>
 #include <QQmlIncubator>
+#include <QPointer>
 #include <QTimer>
 
 #include <QDebug>
@@ -44,6 +45,7 @@ public:
         : q(parent),
           engine(nullptr),
           component(nullptr),
+          ownsComponent(true),
           delay(false)
     {
         executionEndTimer = new QTimer(q);
@@ -52,13 +54,11 @@ public:
         QObject::connect(executionEndTimer, SIGNAL(timeout()), q, SLOT(scheduleExecutionEnd()));
     }
 
-    ~QmlObjectPrivate()
-    {
-        delete incubator.object();
-    }
+    ~QmlObjectPrivate();
 
     void errorPrint(QQmlComponent *component);
     void execute(const QUrl &source);
+    void setComponent(QQmlComponent *newComponent, bool owned);
     void scheduleExecutionEnd();
     void minimumWidthChanged();
     void minimumHeightChanged();
@@ -71,17 +71,50 @@ public:
     QmlObject *q;
 
     QUrl source;
-    QQmlEngine *engine;
+    // a shared engine may be gone by the time this is destroyed
+    QPointer<QQmlEngine> engine;
     QmlObjectIncubator incubator;
-    QQmlComponent *component;
+    QPointer<QQmlComponent> component;
     QTimer *executionEndTimer;
     KDeclarative kdeclarative;
     KLocalizedContext *context{ nullptr };
     KPackage::Package package;
     QQmlContext *rootContext;
+    bool ownsComponent : 1;
     bool delay : 1;
 };
 
+// Components may be shared with the views cloned from this one, which can still
+// be loading or incubating from them: they are only deleted once done with
+static void releaseComponent(QQmlComponent *component, QQmlEngine *engine)
+{
+    // the clones share the engine, without it nothing uses the component anymore
+    if (!engine) {
+        delete component;
+        return;
+    }
+
+    component->setParent(engine);
+    if (component->isLoading()) {
+        QObject::connect(component, &QQmlComponent::statusChanged, component, [component](QQmlComponent::Status status) {
+            if (status != QQmlComponent::Loading) {
+                component->deleteLater();
+            }
+        });
+    } else {
+        component->deleteLater();
+    }
+}
+
+QmlObjectPrivate::~QmlObjectPrivate()
+{
+    delete incubator.object();
+    if (component && ownsComponent) {
+        QObject::disconnect(component, nullptr, q, nullptr);
+        releaseComponent(component, engine);
+    }
+}
+
 void QmlObjectPrivate::errorPrint(QQmlComponent *component)
 {
     QString errorStr = QStringLiteral("Error loading QML file.\n");
@@ -102,13 +135,10 @@ void QmlObjectPrivate::execute(const QUrl &source)
         return;
     }
 
-    delete component;
-    component = new QQmlComponent(engine, q);
-    QObject::connect(component, &QQmlComponent::statusChanged,
-                     q, &QmlObject::statusChanged, Qt::QueuedConnection);
-    delete incubator.object();
+    QQmlComponent *newComponent = new QQmlComponent(engine, q);
+    setComponent(newComponent, true);
 
-    component->loadUrl(source);
+    newComponent->loadUrl(source);
 
     if (delay) {
         executionEndTimer->start(0);
@@ -117,6 +147,30 @@ void QmlObjectPrivate::execute(const QUrl &source)
     }
 }
 
+void QmlObjectPrivate::setComponent(QQmlComponent *newComponent, bool owned)
+{
+    if (component) {
+        QObject::disconnect(component, nullptr, q, nullptr);
+        if (ownsComponent) {
+            releaseComponent(component, engine);
+        }
+    }
+    component = newComponent;
+    ownsComponent = owned;
+    QObject::connect(component, &QQmlComponent::statusChanged,
+                     q, &QmlObject::statusChanged, Qt::QueuedConnection);
+    // a component handed over already loaded won't change its status anymore
+    if (component->isReady() || component->isError()) {
+        QPointer<QQmlComponent> handedOver = component;
+        QMetaObject::invokeMethod(q, [this, handedOver]() {
+            if (handedOver && handedOver == component) {
+                Q_EMIT q->statusChanged(handedOver->status());
+            }
+        }, Qt::QueuedConnection);
+    }
+    delete incubator.object();
+}
+
 void QmlObjectPrivate::scheduleExecutionEnd()
 {
     if (component->isReady() || component->isError()) {
@@ -256,6 +310,27 @@ QQmlComponent *QmlObject::mainComponent() const
     return d->component;
 }
 
+void QmlObject::setMainComponent(QQmlComponent *component)
+{
+    if (!component) {
+        qWarning() << "Null component passed to setMainComponent";
+        return;
+    }
+    if (component->engine() != d->engine) {
+        qWarning() << "The component for" << component->url() << "belongs to a different engine";
+        return;
+    }
+
+    d->source = component->url();
+    d->setComponent(component, false);
+
+    if (d->delay) {
+        d->executionEndTimer->start(0);
+    } else {
+        d->scheduleExecutionEnd();
+    }
+}
+
 QQmlContext *QmlObject::rootContext() const
 {
     return d->rootContext;
@@ -295,6 +370,12 @@ void QmlObject::completeInitialization(const QVariantHash &initialProperties)
         return;
     }
 
+    if (d->incubator.status() == QQmlIncubator::Loading) {
+        // already being created asynchronously, finish it now
+        d->incubator.forceCompletion();
+        return;
+    }
+
     if (!d->component) {
         qWarning() << "No component for" << source();
         return;
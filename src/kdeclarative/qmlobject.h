@@ -164,6 +164,20 @@ public:
      */
     QQmlComponent *mainComponent() const;
 
+    /**
+     * Uses an already existing component as the main component, instead of
+     * loading one from a source url. This allows to create several root objects
+     * out of the same compiled QML, for instance the main component of another
+     * QmlObject using the same engine.
+     *
+     * The component is not owned by this object: if it gets deleted,
+     * mainComponent() will return nullptr while the root object stays valid.
+     *
+     * @param component a component created with the same engine as this object
+     * @since 5.80
+     */
+    void setMainComponent(QQmlComponent *component);
+
     /**
      * The components's creation context.
      * @since 5.11
@@ -206,6 +220,8 @@ public Q_SLOTS:
     /**
      * Finishes the process of initialization.
      * If isInitializationDelayed() is false, calling this will have no effect.
+     * If the object is already being created asynchronously, its creation
+     * is completed right away (since 5.80).
      * @param initialProperties optional properties that will be set on
      *             the object when created (and before Component.onCompleted
      *             gets emitted
@@ -6,10 +6,33 @@
 
 #include "columnproxymodel.h"
 
+#include <algorithm>
+
+// all the roles when any of them is
+static QVector<int> unitedRoles(const QVector<int>& rolesA, const QVector<int>& rolesB)
+{
+    if (rolesA.isEmpty() || rolesB.isEmpty()) {
+        return QVector<int>();
+    }
+
+    QVector<int> roles = rolesA;
+    for (int role : rolesB) {
+        if (!roles.contains(role)) {
+            roles << role;
+        }
+    }
+    return roles;
+}
+
 ColumnProxyModel::ColumnProxyModel(QObject* parent)
     : QAbstractListModel(parent)
     , m_column(0)
+    , m_hasRootItem(false)
+    , m_removingRoot(false)
+    , m_changingLayout(false)
+    , m_pendingMove(NoMove)
     , m_sourceModel(nullptr)
+    , m_flushScheduled(false)
 {}
 
 void ColumnProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
@@ -17,77 +40,75 @@ void ColumnProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
     if(sourceModel==m_sourceModel) {
         return;
     }
-    
+
     beginResetModel();
+    m_pendingChanges.clear();
+    replaceSourceModel(sourceModel);
+    endResetModel();
+}
+
+void ColumnProxyModel::replaceSourceModel(QAbstractItemModel* sourceModel)
+{
     if(m_sourceModel) {
-        disconnect(m_sourceModel, SIGNAL(destroyed(QObject*)),
-                this, SLOT(sourceDestroyed(QObject*)));
-        
-        disconnect(m_sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
-                this, SLOT(considerDataChanged(QModelIndex,QModelIndex)));
-        disconnect(m_sourceModel, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)),
-                this, SLOT(considerRowsAboutToBeInserted(QModelIndex,int,int)));
-        disconnect(m_sourceModel, SIGNAL(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
-                this, SLOT(considerRowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)));
-        disconnect(m_sourceModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
-                this, SLOT(considerRowsAboutToBeRemoved(QModelIndex,int,int)));        
-        disconnect(m_sourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
-                this, SLOT(considerRowsInserted(QModelIndex,int,int)));
-        disconnect(m_sourceModel, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
-                this, SLOT(considerRowsMoved(QModelIndex,int,int,QModelIndex,int)));
-        disconnect(m_sourceModel, SIGNAL(rowsRemoved(QModelIndex,int,int)),
-                this, SLOT(considerRowsRemoved(QModelIndex,int,int)));
-        
-        disconnect(m_sourceModel, SIGNAL(modelAboutToBeReset()),
-                this, SIGNAL(modelAboutToBeReset()));
-        disconnect(m_sourceModel, SIGNAL(modelReset()),
-                this, SIGNAL(modelReset()));
-        disconnect(m_sourceModel, SIGNAL(headerDataChanged(Qt::Orientation,int,int)),
-                this, SIGNAL(headerDataChanged(Qt::Orientation,int,int)));
-        disconnect(m_sourceModel, SIGNAL(layoutAboutToBeChanged()),
-                this, SIGNAL(layoutAboutToBeChanged()));
-        disconnect(m_sourceModel, SIGNAL(layoutChanged()),
-                this, SIGNAL(layoutChanged()));
+        disconnect(m_sourceModel, nullptr, this, nullptr);
     }
     m_sourceModel = sourceModel;
-    if(m_sourceModel) {
-        connect(m_sourceModel, SIGNAL(destroyed(QObject*)),
-                this, SLOT(sourceDestroyed(QObject*)));
-        
-        connect(m_sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
-                this, SLOT(considerDataChanged(QModelIndex,QModelIndex)));
-        connect(m_sourceModel, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)),
-                this, SLOT(considerRowsAboutToBeInserted(QModelIndex,int,int)));
-        connect(m_sourceModel, SIGNAL(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
-                this, SLOT(considerRowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)));
-        connect(m_sourceModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
-                this, SLOT(considerRowsAboutToBeRemoved(QModelIndex,int,int)));        
-        connect(m_sourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
-                this, SLOT(considerRowsInserted(QModelIndex,int,int)));
-        connect(m_sourceModel, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
-                this, SLOT(considerRowsMoved(QModelIndex,int,int,QModelIndex,int)));
-        connect(m_sourceModel, SIGNAL(rowsRemoved(QModelIndex,int,int)),
-                this, SLOT(considerRowsRemoved(QModelIndex,int,int)));
-        
-        connect(m_sourceModel, SIGNAL(modelAboutToBeReset()),
-                this, SIGNAL(modelAboutToBeReset()));
-        connect(m_sourceModel, SIGNAL(modelReset()),
-                this, SIGNAL(modelReset()));
-        connect(m_sourceModel, SIGNAL(headerDataChanged(Qt::Orientation,int,int)),
-                this, SIGNAL(headerDataChanged(Qt::Orientation,int,int)));
-        connect(m_sourceModel, SIGNAL(layoutAboutToBeChanged()),
-                this, SIGNAL(layoutAboutToBeChanged()));
-        connect(m_sourceModel, SIGNAL(layoutChanged()),
-                this, SIGNAL(layoutChanged()));
+    resolveWatchedRoles();
+    if(!m_sourceModel) {
+        return;
     }
-    endResetModel();
+
+    connect(m_sourceModel, &QObject::destroyed,
+            this, &ColumnProxyModel::sourceDestroyed);
+
+    connect(m_sourceModel, &QAbstractItemModel::dataChanged,
+            this, &ColumnProxyModel::considerDataChanged);
+    connect(m_sourceModel, &QAbstractItemModel::rowsAboutToBeInserted,
+            this, &ColumnProxyModel::considerRowsAboutToBeInserted);
+    connect(m_sourceModel, &QAbstractItemModel::rowsAboutToBeMoved,
+            this, &ColumnProxyModel::considerRowsAboutToBeMoved);
+    connect(m_sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &ColumnProxyModel::considerRowsAboutToBeRemoved);
+    connect(m_sourceModel, &QAbstractItemModel::rowsInserted,
+            this, &ColumnProxyModel::considerRowsInserted);
+    connect(m_sourceModel, &QAbstractItemModel::rowsMoved,
+            this, &ColumnProxyModel::considerRowsMoved);
+    connect(m_sourceModel, &QAbstractItemModel::rowsRemoved,
+            this, &ColumnProxyModel::considerRowsRemoved);
+
+    connect(m_sourceModel, &QAbstractItemModel::modelAboutToBeReset,
+            this, [this]() {
+                beginResetModel();
+                m_pendingChanges.clear();
+            });
+    connect(m_sourceModel, &QAbstractItemModel::modelReset,
+            this, [this]() {
+                resolveWatchedRoles();
+                endResetModel();
+            });
+    connect(m_sourceModel, &QAbstractItemModel::headerDataChanged,
+            this, &QAbstractItemModel::headerDataChanged);
+    connect(m_sourceModel, &QAbstractItemModel::layoutAboutToBeChanged,
+            this, &ColumnProxyModel::considerLayoutAboutToBeChanged);
+    connect(m_sourceModel, &QAbstractItemModel::layoutChanged,
+            this, &ColumnProxyModel::considerLayoutChanged);
 }
 
 void ColumnProxyModel::setColumn(int col)
 {
-    beginResetModel();
+    if (col == m_column) {
+        return;
+    }
+
+    //the rows stay the same, only their data changes
     m_column = col;
-    endResetModel();
+    m_pendingChanges.clear();
+    const int rows = rowCount();
+    QVector<int> changedRoles;
+    if (rows > 0 && filterRoles(changedRoles)) {
+        Q_EMIT dataChanged(index(0), index(rows - 1), changedRoles);
+    }
+    Q_EMIT columnChanged();
 }
 
 int ColumnProxyModel::column() const
@@ -95,6 +116,98 @@ int ColumnProxyModel::column() const
     return m_column;
 }
 
+QStringList ColumnProxyModel::watchedRoles() const
+{
+    return m_watchedRoleNames;
+}
+
+void ColumnProxyModel::setWatchedRoles(const QStringList& roleNames)
+{
+    if (roleNames == m_watchedRoleNames) {
+        return;
+    }
+
+    //the changes gathered so far are announced as filtered when they happened
+    emitPendingDataChanged();
+    m_watchedRoleNames = roleNames;
+    resolveWatchedRoles();
+    Q_EMIT watchedRolesChanged();
+}
+
+void ColumnProxyModel::resolveWatchedRoles()
+{
+    m_watchedRoles.clear();
+    if (m_watchedRoleNames.isEmpty() || !m_sourceModel) {
+        return;
+    }
+
+    const QHash<int, QByteArray> roleNames = m_sourceModel->roleNames();
+    for (auto it = roleNames.constBegin(); it != roleNames.constEnd(); ++it) {
+        if (m_watchedRoleNames.contains(QString::fromUtf8(it.value()))) {
+            m_watchedRoles << it.key();
+        }
+    }
+    std::sort(m_watchedRoles.begin(), m_watchedRoles.end());
+}
+
+bool ColumnProxyModel::filterRoles(QVector<int>& roles) const
+{
+    if (m_watchedRoleNames.isEmpty()) {
+        return true;
+    }
+
+    //none of the watched roles is known to the source model, nothing to announce
+    if (m_watchedRoles.isEmpty()) {
+        return false;
+    }
+
+    //a change of all the roles is a change of the watched ones
+    if (roles.isEmpty()) {
+        roles = m_watchedRoles;
+        return true;
+    }
+
+    roles.erase(std::remove_if(roles.begin(), roles.end(), [this](int role) {
+        return !std::binary_search(m_watchedRoles.constBegin(), m_watchedRoles.constEnd(), role);
+    }), roles.end());
+    return !roles.isEmpty();
+}
+
+void ColumnProxyModel::queueDataChanged(int first, int last, const QVector<int>& roles)
+{
+    //models often change their rows one after the other, the last change is extended
+    if (!m_pendingChanges.isEmpty()) {
+        PendingChange& previous = m_pendingChanges.last();
+        if (previous.roles == roles && first <= previous.last + 1 && last >= previous.first - 1) {
+            previous.first = qMin(previous.first, first);
+            previous.last = qMax(previous.last, last);
+            return;
+        }
+        if (previous.first == first && previous.last == last) {
+            previous.roles = unitedRoles(previous.roles, roles);
+            return;
+        }
+    }
+
+    m_pendingChanges.append({first, last, roles});
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(this, [this]() {
+            m_flushScheduled = false;
+            emitPendingDataChanged();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ColumnProxyModel::emitPendingDataChanged()
+{
+    const QVector<PendingChange> changes = m_pendingChanges;
+    m_pendingChanges.clear();
+    for (const PendingChange& change : changes) {
+        Q_EMIT dataChanged(index(change.first), index(change.last), change.roles);
+    }
+}
+
 QModelIndex ColumnProxyModel::rootIndex() const
 {
     return m_index;
@@ -102,17 +215,19 @@ QModelIndex ColumnProxyModel::rootIndex() const
 
 void ColumnProxyModel::setRootIndex(const QModelIndex& index)
 {
-    if (index == m_index) {
+    if (index == m_index && index.isValid() == m_hasRootItem) {
         return;
     }
 
-    if(index.isValid()) {
-        setSourceModel(const_cast<QAbstractItemModel*>(index.model()));
-    }
     beginResetModel();
+    m_pendingChanges.clear();
+    if(index.isValid() && index.model() != m_sourceModel) {
+        replaceSourceModel(const_cast<QAbstractItemModel*>(index.model()));
+    }
     m_index = index;
+    m_hasRootItem = index.isValid();
     endResetModel();
-    
+
     Q_EMIT rootIndexChanged();
 }
 
@@ -138,23 +253,53 @@ QModelIndex ColumnProxyModel::sourceIndex(const QModelIndex& proxyIndex) const
 
 int ColumnProxyModel::rowCount(const QModelIndex& parent) const
 {
-    return (!m_sourceModel || parent.isValid()) ? 0 : m_sourceModel->rowCount(m_index);
+    //once the root item is removed there's nothing left to show
+    if (!m_sourceModel || parent.isValid() || (m_hasRootItem && !m_index.isValid())) {
+        return 0;
+    }
+    return m_sourceModel->rowCount(m_index);
 }
 
 QModelIndex ColumnProxyModel::proxyIndex(const QModelIndex& sourceIndex) const
 {
-    if(sourceIndex.parent()==m_index)
-        return index(sourceIndex.row(), sourceIndex.column(), QModelIndex());
-    
+    //rows map one to one, whatever column is shown
+    if(sourceIndex.isValid() && isRoot(sourceIndex.parent()))
+        return index(sourceIndex.row(), 0, QModelIndex());
+
     return QModelIndex();
 }
 
+bool ColumnProxyModel::isRoot(const QModelIndex& sourceParent) const
+{
+    //a removed root item doesn't stand for the top level items
+    return sourceParent == m_index && (sourceParent.isValid() || !m_hasRootItem);
+}
+
+bool ColumnProxyModel::isRootInRows(const QModelIndex& sourceParent, int rA, int rB) const
+{
+    for (QModelIndex idx = m_index; idx.isValid(); idx = idx.parent()) {
+        if (idx.row() >= rA && idx.row() <= rB && idx.parent() == sourceParent) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void ColumnProxyModel::sourceDestroyed(QObject* source)
 {
     Q_ASSERT(source==m_sourceModel);
-    
+
     beginResetModel();
     m_sourceModel = nullptr;
+    m_index = QModelIndex();
+    m_hasRootItem = false;
+    m_removingRoot = false;
+    m_changingLayout = false;
+    m_pendingMove = NoMove;
+    m_layoutChangePersistentIndexes.clear();
+    m_proxyIndexes.clear();
+    m_pendingChanges.clear();
+    m_watchedRoles.clear();
     endResetModel();
 }
 
@@ -165,61 +310,127 @@ QModelIndex ColumnProxyModel::indexAt(int row, const QModelIndex& parent) const
 
 /////////////////
 
-void ColumnProxyModel::considerDataChanged(const QModelIndex& idxA, const QModelIndex& idxB)
+void ColumnProxyModel::considerDataChanged(const QModelIndex& idxA, const QModelIndex& idxB, const QVector<int>& roles)
 {
-    if(idxA.parent()==m_index && idxB.parent()==m_index) {
-        Q_EMIT dataChanged(proxyIndex(idxA), proxyIndex(idxB));
+    //both corners share the same parent, only the shown column matters
+    if(idxA.column() <= m_column && m_column <= idxB.column() && isRoot(idxA.parent())) {
+        QVector<int> changedRoles = roles;
+        if(filterRoles(changedRoles)) {
+            queueDataChanged(idxA.row(), idxB.row(), changedRoles);
+        }
     }
 }
 
 void ColumnProxyModel::considerRowsAboutToBeInserted(const QModelIndex& parent, int rA, int rB)
 {
-    if(parent==m_index) {
+    //the pending changes refer to the rows as they are now
+    emitPendingDataChanged();
+    if(isRoot(parent)) {
         beginInsertRows(QModelIndex(), rA, rB);
     }
 }
 
 void ColumnProxyModel::considerRowsAboutToBeMoved(const QModelIndex &sourceParent, int rA, int rB, const QModelIndex& destParent, int rD)
 {
-    if(sourceParent==m_index && destParent==m_index) {
-        beginMoveRows(QModelIndex(), rA, rB, QModelIndex(), rD);
-    } else if(sourceParent==m_index) {
-        beginRemoveRows(sourceParent, rA, rB); 
-    } else if(destParent==m_index) {
-        beginInsertRows(destParent, rD, rD+(rB-rA));
+    emitPendingDataChanged();
+
+    //the root item itself may move, it is followed by m_index
+    const bool fromRoot = isRoot(sourceParent);
+    const bool toRoot = isRoot(destParent);
+    if(fromRoot && toRoot) {
+        m_pendingMove = beginMoveRows(QModelIndex(), rA, rB, QModelIndex(), rD) ? MoveRows : NoMove;
+    } else if(fromRoot) {
+        beginRemoveRows(QModelIndex(), rA, rB);
+        m_pendingMove = RemoveRows;
+    } else if(toRoot) {
+        beginInsertRows(QModelIndex(), rD, rD+(rB-rA));
+        m_pendingMove = InsertRows;
     }
 }
 
 void ColumnProxyModel::considerRowsAboutToBeRemoved(const QModelIndex& parent, int rA, int rB)
 {
-    if(parent==m_index) {
+    emitPendingDataChanged();
+    if(isRoot(parent)) {
         beginRemoveRows(QModelIndex(), rA, rB);
+    } else if(isRootInRows(parent, rA, rB)) {
+        //the root item goes away, and all of its rows with it
+        m_removingRoot = true;
+        beginResetModel();
     }
 }
 
 void ColumnProxyModel::considerRowsInserted(const QModelIndex& parent, int , int )
 {
-    if(parent==m_index) {
+    if(isRoot(parent)) {
         endInsertRows();
     }
 }
 
-void ColumnProxyModel::considerRowsMoved(const QModelIndex& sourceParent, int , int , const QModelIndex& destParent, int )
+void ColumnProxyModel::considerRowsMoved(const QModelIndex& , int , int , const QModelIndex& , int )
 {
-    if(sourceParent==m_index && destParent==m_index) {
+    //the parents might not compare the same anymore, rely on what was started
+    const PendingMove pendingMove = m_pendingMove;
+    m_pendingMove = NoMove;
+    switch (pendingMove) {
+    case MoveRows:
         endMoveRows();
-    } else if(sourceParent==m_index) {
+        break;
+    case RemoveRows:
         endRemoveRows();
-    } else if(destParent==m_index) {
+        break;
+    case InsertRows:
         endInsertRows();
+        break;
+    case NoMove:
+        break;
     }
 }
 
 void ColumnProxyModel::considerRowsRemoved(const QModelIndex& parent, int , int )
 {
-    if(parent==m_index) {
-        endInsertRows();
+    if(m_removingRoot) {
+        m_removingRoot = false;
+        endResetModel();
+        Q_EMIT rootIndexChanged();
+    } else if(isRoot(parent)) {
+        endRemoveRows();
+    }
+}
+
+void ColumnProxyModel::considerLayoutAboutToBeChanged(const QList<QPersistentModelIndex>& parents, QAbstractItemModel::LayoutChangeHint hint)
+{
+    //only the order of the children of the given parents changes
+    if(!parents.isEmpty() && !parents.contains(m_index)) {
+        return;
     }
+
+    emitPendingDataChanged();
+    m_changingLayout = true;
+    Q_EMIT layoutAboutToBeChanged(QList<QPersistentModelIndex>(), hint);
+
+    m_proxyIndexes = persistentIndexList();
+    m_layoutChangePersistentIndexes.clear();
+    m_layoutChangePersistentIndexes.reserve(m_proxyIndexes.size());
+    for (const QModelIndex& proxyIndex : qAsConst(m_proxyIndexes)) {
+        m_layoutChangePersistentIndexes << QPersistentModelIndex(sourceIndex(proxyIndex));
+    }
+}
+
+void ColumnProxyModel::considerLayoutChanged(const QList<QPersistentModelIndex>& , QAbstractItemModel::LayoutChangeHint hint)
+{
+    if(!m_changingLayout) {
+        return;
+    }
+
+    m_changingLayout = false;
+    for (int i = 0; i < m_proxyIndexes.size(); ++i) {
+        changePersistentIndex(m_proxyIndexes.at(i), proxyIndex(m_layoutChangePersistentIndexes.at(i)));
+    }
+    m_proxyIndexes.clear();
+    m_layoutChangePersistentIndexes.clear();
+
+    Q_EMIT layoutChanged(QList<QPersistentModelIndex>(), hint);
 }
 
 QHash<int, QByteArray> ColumnProxyModel::roleNames() const
@@ -8,13 +8,16 @@
 #define COLUMNPROXYMODEL_H
 
 #include <QAbstractListModel>
+#include <QStringList>
+#include <QVector>
 
 class ColumnProxyModel : public QAbstractListModel
 {
     Q_OBJECT
     Q_PROPERTY(QModelIndex rootIndex READ rootIndex WRITE setRootIndex NOTIFY rootIndexChanged)
 //     Q_PROPERTY(QAbstractItemModel* sourceModel READ sourceModel WRITE setSourceModel) //rootIndex sets the model
-    Q_PROPERTY(int column READ column WRITE setColumn)
+    Q_PROPERTY(int column READ column WRITE setColumn NOTIFY columnChanged)
+    Q_PROPERTY(QStringList watchedRoles READ watchedRoles WRITE setWatchedRoles NOTIFY watchedRolesChanged)
     public:
         explicit ColumnProxyModel(QObject* parent = nullptr);
 
@@ -25,8 +28,20 @@ class ColumnProxyModel : public QAbstractListModel
         QAbstractItemModel* sourceModel() const { return m_sourceModel; }
 
         int column() const;
+        /**
+         * Shows another column of the same rows, which only changes the data
+         * of the rows rather than resetting the model.
+         */
         void setColumn(int col);
 
+        QStringList watchedRoles() const;
+        /**
+         * Names of the roles the views actually use. Changes of the data which
+         * touch none of them aren't announced, the others only announce the
+         * watched roles. All the roles are watched when empty, the default.
+         */
+        void setWatchedRoles(const QStringList& roleNames);
+
         Q_SCRIPTABLE static QModelIndex indexFromModel(QAbstractItemModel* model, int row, int column=0, const QModelIndex& parent=QModelIndex());
         Q_SCRIPTABLE QModelIndex indexAt(int row, const QModelIndex& parent = QModelIndex()) const;
 
@@ -39,14 +54,53 @@ class ColumnProxyModel : public QAbstractListModel
 
     Q_SIGNALS:
         void rootIndexChanged();
+        void columnChanged();
+        void watchedRolesChanged();
 
     private:
         QModelIndex proxyIndex(const QModelIndex& sourceIndex) const;
         QModelIndex sourceIndex(const QModelIndex& proxyIndex) const;
+        bool isRoot(const QModelIndex& sourceParent) const;
+        bool isRootInRows(const QModelIndex& sourceParent, int rA, int rB) const;
+        void replaceSourceModel(QAbstractItemModel* sourceModel);
+        void resolveWatchedRoles();
+        bool filterRoles(QVector<int>& roles) const;
+        void queueDataChanged(int first, int last, const QVector<int>& roles);
+        void emitPendingDataChanged();
+
+        // what the move of source rows in progress means for the proxy
+        enum PendingMove {
+            NoMove,
+            MoveRows,
+            RemoveRows,
+            InsertRows
+        };
 
         int m_column;
-        QModelIndex m_index;
+        // follows the root through the moves of the source model
+        QPersistentModelIndex m_index;
+        // the root was a valid index, which may have been removed since
+        bool m_hasRootItem;
+        // the root is being removed from the source model
+        bool m_removingRoot;
+        bool m_changingLayout;
+        PendingMove m_pendingMove;
         QAbstractItemModel* m_sourceModel;
+        // source indexes of the persistent indexes during a layout change
+        QList<QPersistentModelIndex> m_layoutChangePersistentIndexes;
+        QModelIndexList m_proxyIndexes;
+        QStringList m_watchedRoleNames;
+        // sorted, those of the watched roles the source model knows
+        QVector<int> m_watchedRoles;
+
+        // the changes of the data are gathered until the event loop runs
+        struct PendingChange {
+            int first;
+            int last;
+            QVector<int> roles;
+        };
+        QVector<PendingChange> m_pendingChanges;
+        bool m_flushScheduled;
 
     private Q_SLOTS:
         void considerRowsAboutToBeInserted(const QModelIndex&,int,int);
@@ -55,7 +109,9 @@ class ColumnProxyModel : public QAbstractListModel
         void considerRowsRemoved(const QModelIndex&,int,int);
         void considerRowsMoved(const QModelIndex&,int,int,const QModelIndex&,int);
         void considerRowsInserted(const QModelIndex&,int,int);
-        void considerDataChanged(const QModelIndex& idxA, const QModelIndex& idxB);
+        void considerDataChanged(const QModelIndex& idxA, const QModelIndex& idxB, const QVector<int>& roles);
+        void considerLayoutAboutToBeChanged(const QList<QPersistentModelIndex>& parents, QAbstractItemModel::LayoutChangeHint hint);
+        void considerLayoutChanged(const QList<QPersistentModelIndex>& parents, QAbstractItemModel::LayoutChangeHint hint);
         void sourceDestroyed(QObject* source);
 };
 
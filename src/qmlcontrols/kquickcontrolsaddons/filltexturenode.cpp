@@ -0,0 +1,75 @@
+/*
+    SPDX-FileCopyrightText: 2011 Marco Martin <mart@kde.org>
+    SPDX-FileCopyrightText: 2015 Luca Beltrame <lbeltrame@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "filltexturenode.h"
+
+#include <QImage>
+#include <QQuickWindow>
+#include <quickaddons/imagetexturescache.h>
+
+Q_GLOBAL_STATIC(ImageTexturesCache, s_imageTexturesCache)
+
+FillTextureNode::FillTextureNode()
+    : m_devicePixelRatio(1)
+{
+}
+
+void FillTextureNode::setImage(QQuickWindow *window, const QImage &image, FillMode fillMode)
+{
+    m_imageSize = image.size();
+    m_devicePixelRatio = image.devicePixelRatio();
+
+    // atlassed textures can't be repeated
+    const QQuickWindow::CreateTextureOptions options = fillMode >= Tile ? QQuickWindow::CreateTextureOptions() : QQuickWindow::TextureCanUseAtlas;
+    setTexture(s_imageTexturesCache->loadTexture(window, image, options));
+}
+
+void FillTextureNode::updateGeometry(FillMode fillMode, const QRectF &bounds, const QRectF &paintedRect, bool smooth)
+{
+    setFiltering(smooth ? QSGTexture::Linear : QSGTexture::Nearest);
+
+    // the source rect is in texture pixels, past the texture size it repeats
+    QRectF sourceRect(QPointF(0, 0), m_imageSize);
+    QRectF targetRect = paintedRect;
+
+    switch (fillMode) {
+    case Tile:
+        setWrapMode(QSGTexture::Repeat, QSGTexture::Repeat);
+        sourceRect.setSize(bounds.size() * m_devicePixelRatio);
+        targetRect = bounds;
+        break;
+    case TileVertically:
+        setWrapMode(QSGTexture::ClampToEdge, QSGTexture::Repeat);
+        sourceRect.setHeight(bounds.height() * m_devicePixelRatio);
+        targetRect = bounds;
+        break;
+    case TileHorizontally:
+        setWrapMode(QSGTexture::Repeat, QSGTexture::ClampToEdge);
+        sourceRect.setWidth(bounds.width() * m_devicePixelRatio);
+        targetRect = bounds;
+        break;
+    case PreserveAspectCrop: {
+        setWrapMode(QSGTexture::ClampToEdge, QSGTexture::ClampToEdge);
+        // only the part of the scaled image within the item is shown
+        targetRect = paintedRect.intersected(bounds);
+        const qreal scaleX = m_imageSize.width() / paintedRect.width();
+        const qreal scaleY = m_imageSize.height() / paintedRect.height();
+        sourceRect = QRectF((targetRect.x() - paintedRect.x()) * scaleX,
+                            (targetRect.y() - paintedRect.y()) * scaleY,
+                            targetRect.width() * scaleX,
+                            targetRect.height() * scaleY);
+        break;
+    }
+    case Stretch:
+    case PreserveAspectFit:
+        setWrapMode(QSGTexture::ClampToEdge, QSGTexture::ClampToEdge);
+        break;
+    }
+
+    setSourceRect(sourceRect);
+    setRect(targetRect);
+}
@@ -0,0 +1,52 @@
+/*
+    SPDX-FileCopyrightText: 2011 Marco Martin <mart@kde.org>
+    SPDX-FileCopyrightText: 2015 Luca Beltrame <lbeltrame@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef FILLTEXTURENODE_H
+#define FILLTEXTURENODE_H
+
+#include <quickaddons/managedtexturenode.h>
+
+class QImage;
+class QQuickWindow;
+
+/**
+ * Texture node shared by QImageItem and QPixmapItem, laying out an image
+ * in an item the way their fill modes describe, entirely on the GPU.
+ */
+class FillTextureNode : public ManagedTextureNode
+{
+public:
+    // same values as QImageItem::FillMode and QPixmapItem::FillMode
+    enum FillMode {
+        Stretch,
+        PreserveAspectFit,
+        PreserveAspectCrop,
+        Tile,
+        TileVertically,
+        TileHorizontally,
+    };
+
+    FillTextureNode();
+
+    /**
+     * Uploads @p image through a cache shared by all the items of @p window,
+     * tiling fill modes need a standalone texture to be repeated.
+     */
+    void setImage(QQuickWindow *window, const QImage &image, FillMode fillMode);
+
+    /**
+     * Lays out the texture within @p bounds, @p paintedRect being the
+     * area covered by the scaled image for the non tiling fill modes.
+     */
+    void updateGeometry(FillMode fillMode, const QRectF &bounds, const QRectF &paintedRect, bool smooth);
+
+private:
+    QSize m_imageSize;
+    qreal m_devicePixelRatio;
+};
+
+#endif
@@ -9,18 +9,57 @@
 
 #include <QQuickWindow>
 #include <QIcon>
+#include <QTimer>
+#include <QtMath>
+
 #include <quickaddons/imagetexturescache.h>
 #include <quickaddons/managedtexturenode.h>
 
-Q_GLOBAL_STATIC(ImageTexturesCache, s_iconImageCache)
+// QIcon::pixmap() gives a new image each time, share the textures of equal icons by their content.
+// Small icons go in the atlas, so that views full of icons can be drawn in few batches
+class IconTexturesCache : public ImageTexturesCache
+{
+public:
+    IconTexturesCache()
+    {
+        setContentAddressed(true);
+        setAtlasSizeLimit(64);
+    }
+};
+
+Q_GLOBAL_STATIC(IconTexturesCache, s_iconImageCache)
+
+// how long after the last size change a resize is considered finished
+static const int s_resizeSettleDelay = 150;
+
+static int bucketedExtent(int extent)
+{
+    // the standard icon sizes, then powers of two
+    static const int steps[] = {16, 22, 32, 48, 64, 96, 128, 192, 256};
+    for (int step : steps) {
+        if (extent <= step) {
+            return step;
+        }
+    }
+    return int(qNextPowerOfTwo(quint32(extent - 1)));
+}
 
 QIconItem::QIconItem(QQuickItem *parent)
     : QQuickItem(parent),
       m_smooth(false),
       m_state(DefaultState),
-      m_changed(false)
+      m_changed(false),
+      m_deferred(false),
+      m_imageRequested(false),
+      m_resizeTimer(new QTimer(this)),
+      m_resizing(false),
+      m_geometryChanged(false)
 {
     setFlag(ItemHasContents, true);
+
+    m_resizeTimer->setSingleShot(true);
+    m_resizeTimer->setInterval(s_resizeSettleDelay);
+    connect(m_resizeTimer, &QTimer::timeout, this, &QIconItem::resizeFinished);
 }
 
 
@@ -37,8 +76,7 @@ void QIconItem::setIcon(const QVariant &icon)
     } else {
         m_icon = QIcon();
     }
-    m_changed = true;
-    update();
+    iconChangedInternal();
     Q_EMIT iconChanged();
 }
 
@@ -59,9 +97,8 @@ void QIconItem::setState(QIconItem::State state)
     }
 
     m_state = state;
-    m_changed = true;
+    iconChangedInternal();
     Q_EMIT stateChanged(state);
-    update();
 }
 
 bool QIconItem::enabled() const
@@ -104,6 +141,105 @@ bool QIconItem::smooth() const
     return m_smooth;
 }
 
+void QIconItem::setDeferred(bool deferred)
+{
+    if (deferred == m_deferred) {
+        return;
+    }
+    m_deferred = deferred;
+    if (m_deferred) {
+        requestImage();
+    } else {
+        m_image = QImage();
+    }
+    m_changed = true;
+    update();
+    Q_EMIT deferredChanged();
+}
+
+bool QIconItem::isDeferred() const
+{
+    return m_deferred;
+}
+
+QIcon::Mode QIconItem::iconMode() const
+{
+    switch(m_state) {
+        case ActiveState:
+            return QIcon::Active;
+        case DisabledState:
+            return QIcon::Disabled;
+        case SelectedState:
+            return QIcon::Selected;
+        case DefaultState:
+            break;
+    }
+    return QIcon::Normal;
+}
+
+void QIconItem::iconChangedInternal()
+{
+    m_changed = true;
+    if (m_deferred) {
+        requestImage();
+    }
+    update();
+}
+
+QSize QIconItem::rasterSize() const
+{
+    const QSize size(width(), height());
+    if (m_resizing && !size.isEmpty()) {
+        return QSize(bucketedExtent(size.width()), bucketedExtent(size.height()));
+    }
+    return size;
+}
+
+void QIconItem::resizeFinished()
+{
+    m_resizing = false;
+    // a final crisp rasterization at the exact size
+    if (rasterSize() != m_rasterSize) {
+        iconChangedInternal();
+    } else {
+        // the scaling filter may change
+        m_geometryChanged = true;
+        update();
+    }
+}
+
+void QIconItem::requestImage()
+{
+    // all the changes until the event loop runs are rasterized at once
+    if (m_imageRequested) {
+        return;
+    }
+    m_imageRequested = true;
+    QMetaObject::invokeMethod(this, &QIconItem::rasterizeImage, Qt::QueuedConnection);
+}
+
+void QIconItem::rasterizeImage()
+{
+    m_imageRequested = false;
+    if (!m_deferred) {
+        return;
+    }
+
+    // icon engines, KIconLoader and QPixmapCache are not thread safe, no worker here
+    const QSize size = rasterSize();
+    m_rasterSize = size;
+    QImage image;
+    if (!m_icon.isNull() && !size.isEmpty()) {
+        image = m_icon.pixmap(size, iconMode(), QIcon::On).toImage();
+    }
+
+    // the previous image stays visible until now
+    m_image = image;
+    m_imageRasterSize = size;
+    m_changed = true;
+    update();
+}
+
 QSGNode* QIconItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeData* /*data*/)
 {
     if (m_icon.isNull()) {
@@ -111,6 +247,11 @@ QSGNode* QIconItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeDa
         return nullptr;
     }
 
+    if (m_deferred && m_image.isNull() && !node) {
+        // nothing rasterized yet
+        return nullptr;
+    }
+
     if (m_changed || node == nullptr) {
         m_changed = false;
 
@@ -120,30 +261,28 @@ QSGNode* QIconItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeDa
             mNode = new ManagedTextureNode;
         }
 
-        QIcon::Mode mode;
-        switch(m_state) {
-            case DefaultState:
-                mode = QIcon::Normal;
-                break;
-            case ActiveState:
-                mode = QIcon::Active;
-                break;
-            case DisabledState:
-                mode = QIcon::Disabled;
-                break;
-            case SelectedState:
-                mode = QIcon::Selected;
-                break;
-        }
-
         QImage img;
-        const QSize size(width(), height());
-        if (!size.isEmpty()) {
-            img = m_icon.pixmap(size, mode, QIcon::On).toImage();
+        if (m_deferred) {
+            img = m_image;
+        } else {
+            m_rasterSize = rasterSize();
+            if (!m_rasterSize.isEmpty()) {
+                img = m_icon.pixmap(m_rasterSize, iconMode(), QIcon::On).toImage();
+            }
         }
         mNode->setTexture(s_iconImageCache->loadTexture(window(), img));
-        mNode->setRect(QRect(QPoint(0,0), size));
         node = mNode;
+        m_geometryChanged = true;
+    }
+
+    if (m_geometryChanged) {
+        m_geometryChanged = false;
+        ManagedTextureNode *mNode = static_cast<ManagedTextureNode *>(node);
+        const QSize size(width(), height());
+        const QSize shownRasterSize = m_deferred ? m_imageRasterSize : m_rasterSize;
+        // scale smoothly an image rasterized for another size
+        mNode->setFiltering(shownRasterSize != size ? QSGTexture::Linear : QSGTexture::Nearest);
+        mNode->setRect(QRect(QPoint(0,0), size));
     }
 
     return node;
@@ -152,8 +291,18 @@ QSGNode* QIconItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeDa
 void QIconItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
 {
     if (newGeometry.size() != oldGeometry.size()) {
-        m_changed = true;
-        update();
+        // a resize step, as opposed to the initial sizing
+        if (!oldGeometry.size().isEmpty()) {
+            m_resizing = true;
+            m_resizeTimer->start();
+        }
+        // only rasterize again when crossing a size step
+        if (rasterSize() != m_rasterSize) {
+            iconChangedInternal();
+        } else {
+            m_geometryChanged = true;
+            update();
+        }
     }
     QQuickItem::geometryChanged(newGeometry, oldGeometry);
 }
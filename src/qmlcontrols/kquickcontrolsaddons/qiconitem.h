@@ -8,9 +8,12 @@
 #define QICONITEM_H
 
 #include <QIcon>
+#include <QImage>
 #include <QQuickItem>
 #include <QVariant>
 
+class QTimer;
+
 class QIconItem : public QQuickItem
 {
     Q_OBJECT
@@ -21,6 +24,15 @@ class QIconItem : public QQuickItem
     Q_PROPERTY(int implicitHeight READ implicitHeight CONSTANT)
     Q_PROPERTY(State state READ state WRITE setState NOTIFY stateChanged)
     Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY stateChanged)
+    /**
+     * If true, the icon is rasterized once the event loop runs again instead of
+     * while the scene graph is synchronized, once for all the changes made meanwhile,
+     * the previous image being shown until the new one is ready. The rasterization
+     * still happens on the GUI thread, icon engines can't be used from another one.
+     * False by default.
+     * @since 5.80
+     */
+    Q_PROPERTY(bool deferred READ isDeferred WRITE setDeferred NOTIFY deferredChanged)
 
 public:
 
@@ -50,21 +62,42 @@ public:
     void setEnabled(bool enabled = true);
     bool enabled() const;
 
+    void setDeferred(bool deferred);
+    bool isDeferred() const;
+
     QSGNode* updatePaintNode(QSGNode* node, UpdatePaintNodeData* data) override;
 
 Q_SIGNALS:
     void iconChanged();
     void smoothChanged();
     void stateChanged(State state);
+    void deferredChanged();
 
 protected:
     void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
 
 private:
+    QIcon::Mode iconMode() const;
+    void iconChangedInternal();
+    QSize rasterSize() const;
+    void requestImage();
+    void rasterizeImage();
+    void resizeFinished();
+
     QIcon m_icon;
     bool m_smooth;
     State m_state;
     bool m_changed;
+    bool m_deferred;
+    // rasterized from the event loop when deferred
+    QImage m_image;
+    QSize m_imageRasterSize;
+    bool m_imageRequested;
+    // while resizing, the icon is rasterized at stepped sizes and scaled in between
+    QTimer *m_resizeTimer;
+    QSize m_rasterSize;
+    bool m_resizing;
+    bool m_geometryChanged;
 };
 
 #endif
@@ -7,13 +7,15 @@
 
 #include "qimageitem.h"
 
-#include <QPainter>
+#include "filltexturenode.h"
 
 
 QImageItem::QImageItem(QQuickItem *parent)
-    : QQuickPaintedItem(parent),
+    : QQuickItem(parent),
       m_smooth(false),
-      m_fillMode(QImageItem::Stretch)
+      m_fillMode(QImageItem::Stretch),
+      m_textureChanged(false),
+      m_sourceCacheKey(0)
 {
     setFlag(ItemHasContents, true);
 }
@@ -23,14 +25,46 @@ QImageItem::~QImageItem()
 {
 }
 
+// Scales image down to fit in sourceSize, a dimension of 0 leaves that one unbounded
+static QImage downscaled(const QImage &image, const QSize &sourceSize)
+{
+    if (image.isNull() || (sourceSize.width() <= 0 && sourceSize.height() <= 0)) {
+        return image;
+    }
+
+    const qreal dpr = image.devicePixelRatio();
+    const QSize bounds(sourceSize.width() > 0 ? qRound(sourceSize.width() * dpr) : image.width(),
+                       sourceSize.height() > 0 ? qRound(sourceSize.height() * dpr) : image.height());
+    if (image.width() <= bounds.width() && image.height() <= bounds.height()) {
+        return image;
+    }
+
+    QImage scaled = image.scaled(bounds, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    scaled.setDevicePixelRatio(dpr);
+    return scaled;
+}
+
 void QImageItem::setImage(const QImage &image)
 {
-    bool oldImageNull = m_image.isNull();
-    m_image = image;
+    // the same data set again, as models tend to do when any of their roles change
+    if (image.cacheKey() == m_sourceCacheKey) {
+        return;
+    }
+
+    const bool oldImageNull = m_image.isNull();
+    const int oldNativeWidth = nativeWidth();
+    const int oldNativeHeight = nativeHeight();
+    m_sourceCacheKey = image.cacheKey();
+    m_image = downscaled(image, m_sourceSize);
+    m_textureChanged = true;
     updatePaintedRect();
     update();
-    Q_EMIT nativeWidthChanged();
-    Q_EMIT nativeHeightChanged();
+    if (nativeWidth() != oldNativeWidth) {
+        Q_EMIT nativeWidthChanged();
+    }
+    if (nativeHeight() != oldNativeHeight) {
+        Q_EMIT nativeHeightChanged();
+    }
     Q_EMIT imageChanged();
     if (oldImageNull != m_image.isNull()) {
         Q_EMIT nullChanged();
@@ -42,6 +76,30 @@ QImage QImageItem::image() const
     return m_image;
 }
 
+QSize QImageItem::sourceSize() const
+{
+    return m_sourceSize;
+}
+
+void QImageItem::setSourceSize(const QSize &size)
+{
+    if (size == m_sourceSize) {
+        return;
+    }
+
+    m_sourceSize = size;
+    Q_EMIT sourceSizeChanged();
+
+    // the full resolution image is gone, it can only be scaled down further
+    const QImage scaled = downscaled(m_image, m_sourceSize);
+    if (scaled.cacheKey() != m_image.cacheKey()) {
+        const qint64 sourceCacheKey = m_sourceCacheKey;
+        m_sourceCacheKey = 0;
+        setImage(scaled);
+        m_sourceCacheKey = sourceCacheKey;
+    }
+}
+
 void QImageItem::resetImage()
 {
     setImage(QImage());
@@ -82,36 +140,37 @@ void QImageItem::setFillMode(QImageItem::FillMode mode)
         return;
     }
 
+    // tiling needs another kind of texture
+    m_textureChanged = m_textureChanged || (mode >= Tile) != (m_fillMode >= Tile);
     m_fillMode = mode;
     updatePaintedRect();
     update();
     Q_EMIT fillModeChanged();
 }
 
-void QImageItem::paint(QPainter *painter)
+QSGNode *QImageItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
 {
-    if (m_image.isNull()) {
-        return;
-    }
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, m_smooth);
-    painter->setRenderHint(QPainter::SmoothPixmapTransform, m_smooth);
+    Q_UNUSED(data);
 
-     if (m_fillMode == TileVertically) {
-        painter->scale(width()/(qreal)m_image.width(), 1);
+    if (m_image.isNull() || m_paintedRect.isEmpty() || width() <= 0 || height() <= 0) {
+        delete oldNode;
+        return nullptr;
     }
 
-    if (m_fillMode == TileHorizontally) {
-        painter->scale(1, height()/(qreal)m_image.height());
+    FillTextureNode *node = static_cast<FillTextureNode *>(oldNode);
+    if (!node) {
+        node = new FillTextureNode;
+        m_textureChanged = true;
     }
 
-    if (m_fillMode >= Tile) {
-        painter->drawTiledPixmap(m_paintedRect, QPixmap::fromImage(m_image));
-    } else {
-        painter->drawImage(m_paintedRect, m_image, m_image.rect());
+    const FillTextureNode::FillMode fillMode = static_cast<FillTextureNode::FillMode>(m_fillMode);
+    if (m_textureChanged) {
+        m_textureChanged = false;
+        node->setImage(window(), m_image, fillMode);
     }
+    node->updateGeometry(fillMode, boundingRect(), m_paintedRect, m_smooth);
 
-    painter->restore();
+    return node;
 }
 
 bool QImageItem::isNull() const
@@ -190,6 +249,7 @@ void QImageItem::updatePaintedRect()
 
 void QImageItem::geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
 {
-    QQuickPaintedItem::geometryChanged(newGeometry, oldGeometry);
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
     updatePaintedRect();
+    update();
 }
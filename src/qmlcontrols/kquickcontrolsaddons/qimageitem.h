@@ -8,10 +8,10 @@
 #ifndef QIMAGEITEM_H
 #define QIMAGEITEM_H
 
-#include <QQuickPaintedItem>
+#include <QQuickItem>
 #include <QImage>
 
-class QImageItem : public QQuickPaintedItem
+class QImageItem : public QQuickItem
 {
     Q_OBJECT
 
@@ -23,6 +23,12 @@ class QImageItem : public QQuickPaintedItem
     Q_PROPERTY(int paintedHeight READ paintedHeight NOTIFY paintedHeightChanged)
     Q_PROPERTY(FillMode fillMode READ fillMode WRITE setFillMode NOTIFY fillModeChanged)
     Q_PROPERTY(bool null READ isNull NOTIFY nullChanged)
+    /**
+     * Bounds the size the image is kept at, larger images are scaled down
+     * when set. A dimension left to 0 isn't bounded. Images already set are
+     * scaled down when the bounds shrink, but not scaled back up.
+     */
+    Q_PROPERTY(QSize sourceSize READ sourceSize WRITE setSourceSize NOTIFY sourceSizeChanged)
 
 public:
     enum FillMode {
@@ -42,6 +48,9 @@ public:
     QImage image() const;
     void resetImage();
 
+    QSize sourceSize() const;
+    void setSourceSize(const QSize &size);
+
     void setSmooth(const bool smooth);
     bool smooth() const;
 
@@ -54,7 +63,7 @@ public:
     FillMode fillMode() const;
     void setFillMode(FillMode mode);
 
-    void paint(QPainter *painter) override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 
     bool isNull() const;
 
@@ -66,6 +75,7 @@ Q_SIGNALS:
     void nullChanged();
     void paintedWidthChanged();
     void paintedHeightChanged();
+    void sourceSizeChanged();
 
 protected:
     void geometryChanged(const QRectF & newGeometry, const QRectF & oldGeometry) override;
@@ -75,6 +85,10 @@ private:
     bool m_smooth;
     FillMode m_fillMode;
     QRect m_paintedRect;
+    bool m_textureChanged;
+    QSize m_sourceSize;
+    // cache key of the image as set, before being scaled down
+    qint64 m_sourceCacheKey;
 
 private Q_SLOTS:
     void updatePaintedRect();
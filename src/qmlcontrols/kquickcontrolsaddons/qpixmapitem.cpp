@@ -7,13 +7,14 @@
 
 #include "qpixmapitem.h"
 
-#include <QPainter>
+#include "filltexturenode.h"
 
 
 QPixmapItem::QPixmapItem(QQuickItem *parent)
-    : QQuickPaintedItem(parent),
+    : QQuickItem(parent),
       m_smooth(false),
-      m_fillMode(QPixmapItem::Stretch)
+      m_fillMode(QPixmapItem::Stretch),
+      m_textureChanged(false)
 {
     setFlag(ItemHasContents, true);
 
@@ -28,6 +29,7 @@ void QPixmapItem::setPixmap(const QPixmap &pixmap)
 {
     bool oldPixmapNull = m_pixmap.isNull();
     m_pixmap = pixmap;
+    m_textureChanged = true;
     updatePaintedRect();
     update();
     Q_EMIT nativeWidthChanged();
@@ -83,6 +85,8 @@ void QPixmapItem::setFillMode(QPixmapItem::FillMode mode)
         return;
     }
 
+    // tiling needs another kind of texture
+    m_textureChanged = m_textureChanged || (mode >= Tile) != (m_fillMode >= Tile);
     m_fillMode = mode;
     updatePaintedRect();
     update();
@@ -90,30 +94,30 @@ void QPixmapItem::setFillMode(QPixmapItem::FillMode mode)
 
 }
 
-void QPixmapItem::paint(QPainter *painter)
+QSGNode *QPixmapItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
 {
-    if (m_pixmap.isNull()) {
-        return;
-    }
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, m_smooth);
-    painter->setRenderHint(QPainter::SmoothPixmapTransform, m_smooth);
+    Q_UNUSED(data);
 
-    if (m_fillMode == TileVertically) {
-        painter->scale(width()/(qreal)m_pixmap.width(), 1);
+    if (m_pixmap.isNull() || m_paintedRect.isEmpty() || width() <= 0 || height() <= 0) {
+        delete oldNode;
+        return nullptr;
     }
 
-    if (m_fillMode == TileHorizontally) {
-        painter->scale(1, height()/(qreal)m_pixmap.height());
+    FillTextureNode *node = static_cast<FillTextureNode *>(oldNode);
+    if (!node) {
+        node = new FillTextureNode;
+        m_textureChanged = true;
     }
 
-    if (m_fillMode >= Tile) {
-        painter->drawTiledPixmap(m_paintedRect, m_pixmap);
-    } else {
-        painter->drawPixmap(m_paintedRect, m_pixmap, m_pixmap.rect());
+    const FillTextureNode::FillMode fillMode = static_cast<FillTextureNode::FillMode>(m_fillMode);
+    if (m_textureChanged) {
+        m_textureChanged = false;
+        // for raster pixmaps this shares the pixmap's data, keeping its cache key
+        node->setImage(window(), m_pixmap.toImage(), fillMode);
     }
+    node->updateGeometry(fillMode, boundingRect(), m_paintedRect, m_smooth);
 
-    painter->restore();
+    return node;
 }
 
 bool QPixmapItem::isNull() const
@@ -194,7 +198,8 @@ void QPixmapItem::updatePaintedRect()
 
 void QPixmapItem::geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
 {
-    QQuickPaintedItem::geometryChanged(newGeometry, oldGeometry);
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
     updatePaintedRect();
+    update();
 }
 
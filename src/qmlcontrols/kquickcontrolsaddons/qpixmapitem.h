@@ -8,10 +8,10 @@
 #ifndef QPIXMAPITEM_H
 #define QPIXMAPITEM_H
 
-#include <QQuickPaintedItem>
+#include <QQuickItem>
 #include <QPixmap>
 
-class QPixmapItem : public QQuickPaintedItem
+class QPixmapItem : public QQuickItem
 {
     Q_OBJECT
 
@@ -54,8 +54,6 @@ public:
     FillMode fillMode() const;
     void setFillMode(FillMode mode);
 
-    void paint(QPainter *painter) override;
-
     bool isNull() const;
 
 Q_SIGNALS:
@@ -69,12 +67,14 @@ Q_SIGNALS:
 
 protected:
     void geometryChanged(const QRectF & newGeometry, const QRectF & oldGeometry) override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 
 private:
     QPixmap m_pixmap;
     bool m_smooth;
     FillMode m_fillMode;
     QRect m_paintedRect;
+    bool m_textureChanged;
 
 private Q_SLOTS:
     void updatePaintedRect();
@@ -13,12 +13,17 @@
 #include "configmodule.h"
 
 #include <QDebug>
+#include <QMutex>
+#include <QVarLengthArray>
 #include <QUrl>
 #include <QQmlEngine>
 #include <QQmlContext>
+#include <QQmlIncubator>
+#include <QPointer>
 #include <QQuickItem>
 #include <QQmlEngine>
 #include <QQmlFileSelector>
+#include <QFileSelector>
 
 #include <KAboutData>
 #include <KLocalizedString>
@@ -30,6 +35,37 @@
 
 namespace KQuickAddons {
 
+class ConfigModulePrivate;
+
+// Creates a sub page without blocking, once done the page is handed to the module
+class PageIncubator : public QQmlIncubator
+{
+public:
+    PageIncubator(ConfigModulePrivate *module, QQmlComponent *component, const QString &fileName, const QVariantMap &propertyMap)
+        : QQmlIncubator(Asynchronous)
+        , module(module)
+        , component(component)
+        , fileName(fileName)
+        , propertyMap(propertyMap)
+    {
+    }
+
+    ConfigModulePrivate *const module;
+    QQmlComponent *const component;
+    const QString fileName;
+    const QVariantMap propertyMap;
+
+protected:
+    void setInitialState(QObject *object) override
+    {
+        for (auto it = propertyMap.begin(), end = propertyMap.end(); it != end; ++it) {
+            object->setProperty(it.key().toLatin1().constData(), it.value());
+        }
+    }
+
+    void statusChanged(Status status) override;
+};
+
 class ConfigModulePrivate
 {
 public:
@@ -46,7 +82,19 @@ public:
     {
     }
 
+    struct CachedPage {
+        QString fileName;
+        QVariantMap propertyMap;
+        QPointer<QQuickItem> item;
+    };
+
     void authStatusChanged(int status);
+    bool createQmlObject();
+    static void installFileSelector(QQmlEngine *engine);
+    KPackage::Package package();
+    void insertPage(QQuickItem *item);
+    QQuickItem *takeCachedPage(const QString &fileName, const QVariantMap &propertyMap);
+    void incubatorFinished(PageIncubator *incubator);
 
     ConfigModule *_q;
     KDeclarative::QmlObject *_qmlObject;
@@ -56,6 +104,15 @@ public:
     QString _quickHelp;
     QString _errorString;
     QList<QQuickItem *> subPages;
+    // pages created from files, which can be reused once popped
+    QHash<QQuickItem *, CachedPage> filePages;
+    // popped pages kept for reuse, most recently popped first
+    QList<CachedPage> pageCache;
+    int pageCacheSize = 0;
+    QList<PageIncubator *> incubators;
+    QUrl _mainScript;
+    // the main ui is being loaded in the background
+    bool _preloading = false;
     int _columnWidth = -1;
     int currentIndex = 0;
     bool _useRootOnlyMessage : 1;
@@ -67,9 +124,82 @@ public:
     QString _authActionName;
 
     static QHash<QObject *, ConfigModule *> s_rootObjects;
+    // contexts below a root context, already resolved by qmlAttachedProperties()
+    static QHash<const QQmlContext *, ConfigModule *> s_resolvedContexts;
+    // modules can be created by several engines, in different threads,
+    // this also guards the extra file selectors
+    static QMutex s_contextModulesMutex;
+    static QStringList s_extraFileSelectors;
 };
 
 QHash<QObject *, ConfigModule *> ConfigModulePrivate::s_rootObjects = QHash<QObject *, ConfigModule *>();
+QHash<const QQmlContext *, ConfigModule *> ConfigModulePrivate::s_resolvedContexts;
+QMutex ConfigModulePrivate::s_contextModulesMutex;
+QStringList ConfigModulePrivate::s_extraFileSelectors;
+
+void PageIncubator::statusChanged(Status status)
+{
+    if (status == Ready || status == Error) {
+        // the incubator can't be deleted from within its own callback
+        ConfigModulePrivate *priv = module;
+        QMetaObject::invokeMethod(module->_q, [priv, this]() {
+            priv->incubatorFinished(this);
+        }, Qt::QueuedConnection);
+    }
+}
+
+KPackage::Package ConfigModulePrivate::package()
+{
+    KPackage::Package package = KPackage::PackageLoader::self()->loadPackage(QStringLiteral("KPackage/GenericQML"));
+    package.setDefaultPackageRoot(QStringLiteral("kpackage/kcms"));
+    package.setPath(_q->aboutData()->componentName());
+    return package;
+}
+
+void ConfigModulePrivate::insertPage(QQuickItem *item)
+{
+    subPages << item;
+    Q_EMIT _q->pagePushed(item);
+    Q_EMIT _q->depthChanged(_q->depth());
+    _q->setCurrentIndex(currentIndex + 1);
+}
+
+QQuickItem *ConfigModulePrivate::takeCachedPage(const QString &fileName, const QVariantMap &propertyMap)
+{
+    for (int i = 0; i < pageCache.count(); ++i) {
+        const CachedPage &page = pageCache.at(i);
+        if (page.item && page.fileName == fileName && page.propertyMap == propertyMap) {
+            const CachedPage cached = pageCache.takeAt(i);
+            filePages.insert(cached.item, cached);
+            return cached.item;
+        }
+    }
+    return nullptr;
+}
+
+void ConfigModulePrivate::incubatorFinished(PageIncubator *incubator)
+{
+    incubators.removeOne(incubator);
+    QObject *object = incubator->object();
+    QQuickItem *item = qobject_cast<QQuickItem *>(object);
+    if (!item) {
+        qWarning() << "Error creating the page" << incubator->fileName << incubator->errors();
+        delete object;
+        delete incubator->component;
+        delete incubator;
+        return;
+    }
+
+    //memory management
+    incubator->component->setParent(item);
+    if (!incubator->propertyMap.contains(QLatin1String("parent"))) {
+        item->setParentItem(qobject_cast<QQuickItem *>(_qmlObject->rootObject()));
+    }
+    filePages.insert(item, {incubator->fileName, incubator->propertyMap, item});
+    delete incubator;
+
+    insertPage(item);
+}
 
 
 ConfigModule::ConfigModule(const KAboutData *aboutData, QObject *parent, const QVariantList &)
@@ -97,9 +227,29 @@ ConfigModule::ConfigModule(QObject *parent, const QVariantList &)
 
 ConfigModule::~ConfigModule()
 {
-    //in case mainUi was never called
-    if (d->_qmlObject) {
-        ConfigModulePrivate::s_rootObjects.remove(d->_qmlObject->rootContext());
+    // pages still being created or kept for reuse
+    for (PageIncubator *incubator : qAsConst(d->incubators)) {
+        delete incubator->object();
+        delete incubator;
+    }
+    for (const ConfigModulePrivate::CachedPage &page : qAsConst(d->pageCache)) {
+        delete page.item;
+    }
+
+    {
+        QMutexLocker locker(&ConfigModulePrivate::s_contextModulesMutex);
+        //in case mainUi was never called
+        if (d->_qmlObject) {
+            ConfigModulePrivate::s_rootObjects.remove(d->_qmlObject->rootContext());
+        }
+        auto &resolvedContexts = ConfigModulePrivate::s_resolvedContexts;
+        for (auto it = resolvedContexts.begin(); it != resolvedContexts.end();) {
+            if (it.value() == this) {
+                it = resolvedContexts.erase(it);
+            } else {
+                ++it;
+            }
+        }
     }
 
     delete d->_qmlObject;
@@ -113,68 +263,135 @@ ConfigModule *ConfigModule::qmlAttachedProperties(QObject *object)
 {
     //at the moment of the attached object creation, the root item is the only one that hasn't a parent
     //only way to avoid creation of this attached for everybody but the root item
+    if (object->parent()) {
+        return nullptr;
+    }
+
     const QQmlEngine *engine = QtQml::qmlEngine(object);
     QQmlContext *cont = QQmlEngine::contextForObject(object);
 
+    QMutexLocker locker(&ConfigModulePrivate::s_contextModulesMutex);
+
     //Search the qml context that is the "root" for the sharedqmlobject, which
     //is an ancestor of QQmlEngine::contextForObject(object) and the direct child
     //of the engine's root context: we can do this assumption on the internals as
     //we are distributed on the same repo.
-    while (cont->parentContext() && cont->parentContext() != engine->rootContext()) {
+    //Contexts resolved before answer at once, as delegates share them.
+    QVarLengthArray<QQmlContext *, 8> unresolved;
+    ConfigModule *module = nullptr;
+    for (;;) {
+        module = ConfigModulePrivate::s_resolvedContexts.value(cont);
+        if (module) {
+            break;
+        }
+        if (!cont->parentContext() || cont->parentContext() == engine->rootContext()) {
+            module = ConfigModulePrivate::s_rootObjects.value(cont);
+            break;
+        }
+        unresolved.append(cont);
         cont = cont->parentContext();
     }
 
-    if (!object->parent() && ConfigModulePrivate::s_rootObjects.contains(cont)) {
-        return ConfigModulePrivate::s_rootObjects.value(cont);
-    } else {
-        return nullptr;
+    //only the contexts of a module are remembered, until they or the module are gone
+    if (module) {
+        for (QQmlContext *context : qAsConst(unresolved)) {
+            ConfigModulePrivate::s_resolvedContexts.insert(context, module);
+            QObject::connect(context, &QObject::destroyed, module, [context]() {
+                QMutexLocker locker(&ConfigModulePrivate::s_contextModulesMutex);
+                ConfigModulePrivate::s_resolvedContexts.remove(context);
+            });
+        }
     }
+
+    return module;
 }
 
-QQuickItem *ConfigModule::mainUi()
+void ConfigModulePrivate::installFileSelector(QQmlEngine *engine)
 {
-    if (d->_qmlObject) {
-        return qobject_cast<QQuickItem *>(d->_qmlObject->rootObject());
+    // every file selector adds an url interceptor to the engine,
+    // all the modules loaded in the same engine share a single one
+    QQmlFileSelector *selector = QQmlFileSelector::get(engine);
+    if (!selector) {
+        selector = new QQmlFileSelector(engine, engine);
     }
 
-    d->_errorString.clear();
+    QStringList selectors = selector->selector()->extraSelectors();
+    bool changed = false;
+    const QStringList extraSelectors = ConfigModule::extraFileSelectors();
+    for (const QString &extraSelector : extraSelectors) {
+        if (!selectors.contains(extraSelector)) {
+            selectors << extraSelector;
+            changed = true;
+        }
+    }
+    if (changed) {
+        selector->setExtraSelectors(selectors);
+    }
+}
+
+bool ConfigModulePrivate::createQmlObject()
+{
+    _errorString.clear();
 
     // if we have a qml context, hook up to it and use its engine
     // this ensure that in e.g. Plasma config dialogs that use a different engine
     // so they can have different QtQuick Controls styles, we don't end up using
     // the shared engine that is used by the rest of plasma
 
-    QQmlContext *ctx = QQmlEngine::contextForObject(this);
+    QQmlContext *ctx = QQmlEngine::contextForObject(_q);
 
     if (ctx && ctx->engine()) {
-        d->_qmlObject = new KDeclarative::QmlObject(ctx->engine(), ctx, this);
+        _qmlObject = new KDeclarative::QmlObject(ctx->engine(), ctx, _q);
     } else {
-        d->_qmlObject = new KDeclarative::QmlObjectSharedEngine(this);
+        _qmlObject = new KDeclarative::QmlObjectSharedEngine(_q);
     }
 
-    ConfigModulePrivate::s_rootObjects[d->_qmlObject->rootContext()] = this;
-    d->_qmlObject->setTranslationDomain(aboutData()->componentName());
-    d->_qmlObject->setInitializationDelayed(true);
-
-    KPackage::Package package = KPackage::PackageLoader::self()->loadPackage(QStringLiteral("KPackage/GenericQML"));
-    package.setDefaultPackageRoot(QStringLiteral("kpackage/kcms"));
-    package.setPath(aboutData()->componentName());
+    {
+        QMutexLocker locker(&ConfigModulePrivate::s_contextModulesMutex);
+        ConfigModulePrivate::s_rootObjects[_qmlObject->rootContext()] = _q;
+    }
+    _qmlObject->setTranslationDomain(_q->aboutData()->componentName());
+    _qmlObject->setInitializationDelayed(true);
 
+    const KPackage::Package package = this->package();
     if (!package.isValid()) {
-        d->_errorString = i18n("Invalid KPackage '%1'", aboutData()->componentName());
-        qWarning() << "Error loading the module" << aboutData()->componentName() << ": invalid KPackage";
-        return nullptr;
+        _errorString = i18n("Invalid KPackage '%1'", _q->aboutData()->componentName());
+        qWarning() << "Error loading the module" << _q->aboutData()->componentName() << ": invalid KPackage";
+        return false;
     }
 
     if (package.filePath("mainscript").isEmpty()) {
-        d->_errorString = i18n("No QML file provided");
-        qWarning() << "Error loading the module" << aboutData()->componentName() << ": no QML file provided";
-        return nullptr;
+        _errorString = i18n("No QML file provided");
+        qWarning() << "Error loading the module" << _q->aboutData()->componentName() << ": no QML file provided";
+        return false;
     }
 
-    new QQmlFileSelector(d->_qmlObject->engine(), d->_qmlObject->engine());
-    d->_qmlObject->setSource(package.fileUrl("mainscript"));
-    d->_qmlObject->rootContext()->setContextProperty(QStringLiteral("kcm"), this);
+    _mainScript = package.fileUrl("mainscript");
+    installFileSelector(_qmlObject->engine());
+    _qmlObject->rootContext()->setContextProperty(QStringLiteral("kcm"), _q);
+    return true;
+}
+
+QQuickItem *ConfigModule::mainUi()
+{
+    if (d->_qmlObject && !d->_preloading) {
+        return qobject_cast<QQuickItem *>(d->_qmlObject->rootObject());
+    }
+
+    if (d->_preloading) {
+        d->_preloading = false;
+        // still compiling in the background, load it right away
+        if (d->_qmlObject->status() == QQmlComponent::Loading) {
+            d->_qmlObject->setSource(d->_mainScript);
+        }
+    } else {
+        if (!d->createQmlObject()) {
+            return nullptr;
+        }
+        d->_qmlObject->setSource(d->_mainScript);
+    }
+
+    // finishes the incubation a preload may have started
     d->_qmlObject->completeInitialization();
 
     if (d->_qmlObject->status() != QQmlComponent::Ready) {
@@ -185,6 +402,23 @@ QQuickItem *ConfigModule::mainUi()
     return qobject_cast<QQuickItem *>(d->_qmlObject->rootObject());
 }
 
+void ConfigModule::preload()
+{
+    if (d->_qmlObject) {
+        return;
+    }
+
+    if (!d->createQmlObject()) {
+        return;
+    }
+
+    // compiled in the background, then created piece by piece while the engine's
+    // incubation controller, if any, finds time for it
+    d->_preloading = true;
+    QQmlComponent *component = new QQmlComponent(d->_qmlObject->engine(), d->_mainScript, QQmlComponent::Asynchronous, d->_qmlObject);
+    d->_qmlObject->setMainComponent(component);
+}
+
 void ConfigModule::push(const QString &fileName, const QVariantMap &propertyMap)
 {
     //ensure main ui is created
@@ -192,30 +426,69 @@ void ConfigModule::push(const QString &fileName, const QVariantMap &propertyMap)
         return;
     }
 
-    //TODO: package as member
-    KPackage::Package package = KPackage::PackageLoader::self()->loadPackage(QStringLiteral("KPackage/GenericQML"));
-    package.setDefaultPackageRoot(QStringLiteral("kpackage/kcms"));
-    package.setPath(aboutData()->componentName());
+    if (QQuickItem *item = d->takeCachedPage(fileName, propertyMap)) {
+        d->insertPage(item);
+        return;
+    }
 
     QVariantHash propertyHash;
     for (auto it = propertyMap.begin(), end = propertyMap.end(); it != end; ++it) {
         propertyHash.insert(it.key(), it.value());
     }
 
-    QObject *object = d->_qmlObject->createObjectFromSource(QUrl::fromLocalFile(package.filePath("ui", fileName)),
+    QObject *object = d->_qmlObject->createObjectFromSource(QUrl::fromLocalFile(d->package().filePath("ui", fileName)),
                                                             d->_qmlObject->rootContext(),
                                                             propertyHash);
 
     QQuickItem *item = qobject_cast<QQuickItem *>(object);
     if (!item) {
-        object->deleteLater();
+        if (object) {
+            object->deleteLater();
+        }
         return;
     }
 
-    d->subPages << item;
-    Q_EMIT pagePushed(item);
-    Q_EMIT depthChanged(depth());
-    setCurrentIndex(d->currentIndex + 1);
+    d->filePages.insert(item, {fileName, propertyMap, item});
+    d->insertPage(item);
+}
+
+void ConfigModule::pushAsync(const QString &fileName, const QVariantMap &propertyMap)
+{
+    //ensure main ui is created
+    if (!mainUi()) {
+        return;
+    }
+
+    if (QQuickItem *item = d->takeCachedPage(fileName, propertyMap)) {
+        d->insertPage(item);
+        return;
+    }
+
+    QQmlComponent *component = new QQmlComponent(d->_qmlObject->engine(),
+                                                  QUrl::fromLocalFile(d->package().filePath("ui", fileName)),
+                                                  QQmlComponent::Asynchronous,
+                                                  this);
+    auto create = [this, component, fileName, propertyMap]() {
+        if (component->isError()) {
+            qWarning() << "Error loading the page" << fileName << component->errors();
+            component->deleteLater();
+            return;
+        }
+        PageIncubator *incubator = new PageIncubator(d, component, fileName, propertyMap);
+        d->incubators << incubator;
+        component->create(*incubator, d->_qmlObject->rootContext());
+    };
+
+    if (component->isLoading()) {
+        connect(component, &QQmlComponent::statusChanged, this, [component, create](QQmlComponent::Status status) {
+            if (status != QQmlComponent::Loading) {
+                QObject::disconnect(component, &QQmlComponent::statusChanged, nullptr, nullptr);
+                create();
+            }
+        });
+    } else {
+        create();
+    }
 }
 
 void ConfigModule::push(QQuickItem *item)
@@ -225,10 +498,7 @@ void ConfigModule::push(QQuickItem *item)
         return;
     }
 
-    d->subPages << item;
-    Q_EMIT pagePushed(item);
-    Q_EMIT depthChanged(depth());
-    setCurrentIndex(d->currentIndex + 1);
+    d->insertPage(item);
 }
 
 void ConfigModule::pop()
@@ -239,7 +509,20 @@ void ConfigModule::pop()
     QQuickItem *page = d->subPages.takeLast();
     Q_EMIT pageRemoved();
     Q_EMIT depthChanged(depth());
-    page->deleteLater();
+
+    const auto filePage = d->filePages.constFind(page);
+    if (filePage != d->filePages.constEnd() && d->pageCacheSize > 0) {
+        d->pageCache.prepend(*filePage);
+        while (d->pageCache.count() > d->pageCacheSize) {
+            const ConfigModulePrivate::CachedPage dropped = d->pageCache.takeLast();
+            if (dropped.item) {
+                dropped.item->deleteLater();
+            }
+        }
+    } else {
+        page->deleteLater();
+    }
+    d->filePages.remove(page);
 
     setCurrentIndex(qMin(d->currentIndex, depth() - 1));
 }
@@ -334,6 +617,34 @@ int ConfigModule::currentIndex() const
     return d->currentIndex;
 }
 
+void ConfigModule::setPageCacheSize(int size)
+{
+    d->pageCacheSize = qMax(0, size);
+    while (d->pageCache.count() > d->pageCacheSize) {
+        const ConfigModulePrivate::CachedPage dropped = d->pageCache.takeLast();
+        if (dropped.item) {
+            dropped.item->deleteLater();
+        }
+    }
+}
+
+int ConfigModule::pageCacheSize() const
+{
+    return d->pageCacheSize;
+}
+
+void ConfigModule::setExtraFileSelectors(const QStringList &selectors)
+{
+    QMutexLocker locker(&ConfigModulePrivate::s_contextModulesMutex);
+    ConfigModulePrivate::s_extraFileSelectors = selectors;
+}
+
+QStringList ConfigModule::extraFileSelectors()
+{
+    QMutexLocker locker(&ConfigModulePrivate::s_contextModulesMutex);
+    return ConfigModulePrivate::s_extraFileSelectors;
+}
+
 void ConfigModule::setAuthActionName(const QString &name)
 {
     if (d->_authActionName == name) {
@@ -237,6 +237,8 @@ public:
      * @return The main UI for this configuration module. It's a QQuickItem coming from
      * the QML package named the same as the KAboutData's component name for
      * this config module
+     *
+     * If preload() was called, this only finishes what is still left to do.
      */
     QQuickItem *mainUi();
 
@@ -431,6 +433,39 @@ public:
      */
     int currentIndex() const;
 
+    /**
+     * Sets how many popped sub pages are kept around to be reused, rather than destroyed.
+     * A page is reused when pushed again with the same file name and properties,
+     * the state it was left in is kept.
+     *
+     * The default of 0 destroys popped pages.
+     * @since 5.80
+     */
+    void setPageCacheSize(int size);
+
+    /**
+     * @returns how many popped sub pages are kept around to be reused
+     * @since 5.80
+     */
+    int pageCacheSize() const;
+
+    /**
+     * Sets extra selectors for the QQmlFileSelector the QML of config modules is
+     * loaded with, on top of the default ones of QFileSelector.
+     *
+     * Modules sharing an engine share a single file selector, which the selectors
+     * are added to when the next module is loaded. Selectors set previously are
+     * not removed from engines which already loaded a module.
+     * @since 5.80
+     */
+    static void setExtraFileSelectors(const QStringList &selectors);
+
+    /**
+     * @returns the extra selectors the QML of config modules is loaded with
+     * @since 5.80
+     */
+    static QStringList extraFileSelectors();
+
     static ConfigModule *qmlAttachedProperties(QObject *object);
 
     /**
@@ -479,12 +514,30 @@ public Q_SLOTS:
      */
     virtual void defaults();
 
+    /**
+     * Starts building the main UI in the background, for modules the user is
+     * likely to open next: the QML is compiled asynchronously, then the objects
+     * are created in the engine's idle time. mainUi() finishes whatever
+     * is left when it is called.
+     *
+     * Does nothing if the main UI was already built or is being preloaded.
+     * @since 5.80
+     */
+    void preload();
+
     /**
      * Push a new sub page in the KCM hierarchy: pages will be seen as a Kirigami PageRow
      * @since 5.50
      */
     void push(const QString &fileName, const QVariantMap &propertyMap = QVariantMap());
 
+    /**
+     * Push a new sub page in the KCM hierarchy like push(), but without blocking:
+     * the page is loaded and created asynchronously, pagePushed() is emitted once it is ready.
+     * @since 5.80
+     */
+    void pushAsync(const QString &fileName, const QVariantMap &propertyMap = QVariantMap());
+
     /**
      *
      */
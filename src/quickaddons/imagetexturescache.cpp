@@ -5,16 +5,164 @@
 */
 
 #include "imagetexturescache.h"
+#include <QMutex>
 #include <QSGTexture>
+#include <QVector>
 
-typedef QHash<qint64, QHash<QWindow*, QWeakPointer<QSGTexture> > > TexturesCache;
+#include <atomic>
+#include <list>
+
+typedef QVector<QSharedPointer<QSGTexture> > TextureList;
+// an image can have both an atlassed texture and a standalone one, for requests that can't use the atlas
+typedef QPair<qint64, bool> TextureKey;
+
+// Each window is rendered by a single render thread, so textures are kept in
+// per-window sub-caches with their own lock: render threads of different windows
+// never contend, only looking up the sub-cache goes through the shared lock.
+struct WindowTexturesCache
+{
+    struct RetainedTexture {
+        QSharedPointer<QSGTexture> texture;
+        qint64 bytes;
+        std::list<TextureKey>::iterator lruPosition;
+    };
+
+    QMutex mutex;
+    QHash<TextureKey, QWeakPointer<QSGTexture> > textures;
+    // in content addressed mode, the images of the textures, to tell hash collisions apart
+    QHash<qint64, QImage> images;
+    // strong references kept within the retention budget, least recently used first
+    std::list<TextureKey> lru;
+    QHash<TextureKey, RetainedTexture> retained;
+    ImageTexturesCache::Statistics statistics;
+    QMetaObject::Connection invalidatedConnection;
+    // set once removed from ImageTexturesCachePrivate::windows, it must not be used anymore
+    bool detached = false;
+};
+
+typedef QHash<QWindow*, QSharedPointer<WindowTexturesCache> > TexturesCache;
+
+static qint64 contentKey(const QImage &image)
+{
+    uint seed = uint(image.width());
+    seed = seed * 31 + uint(image.height());
+    seed = seed * 31 + uint(image.format());
+    // qHashBits uses the CRC32 instructions of the CPU when available
+    const uint hash = qHashBits(image.constBits(), size_t(image.sizeInBytes()), seed);
+    return (qint64(image.width() & 0xffff) << 48) | (qint64(image.height() & 0xffff) << 32) | hash;
+}
 
 class ImageTexturesCachePrivate
 {
 public:
-    TexturesCache cache;
+    QSharedPointer<WindowTexturesCache> windowCache(QQuickWindow *window);
+    void release(QWindow *window, const TextureKey &key, QSGTexture *texture);
+    void releaseRetained(QWindow *window);
+
+    // the following need the window's mutex to be locked. Textures which are not retained
+    // anymore are moved to dropped, to be released once no lock is held as that can run their deleter
+    void retain(WindowTexturesCache &cache, const TextureKey &key, const QSharedPointer<QSGTexture> &texture, TextureList &dropped);
+    int evict(WindowTexturesCache &cache, qint64 limit, TextureList &dropped);
+
+    // lock order: mutex before any WindowTexturesCache::mutex
+    QMutex mutex;
+    TexturesCache windows;
+
+    std::atomic<bool> contentAddressed{false};
+    std::atomic<int> atlasSizeLimit{0};
+    std::atomic<qint64> budget{0};
+    std::atomic<quint64> hits{0};
+    std::atomic<quint64> misses{0};
+    std::atomic<quint64> uploads{0};
+    std::atomic<quint64> evictions{0};
 };
 
+QSharedPointer<WindowTexturesCache> ImageTexturesCachePrivate::windowCache(QQuickWindow *window)
+{
+    QMutexLocker locker(&mutex);
+    QSharedPointer<WindowTexturesCache> &cache = windows[window];
+    if (!cache) {
+        cache.reset(new WindowTexturesCache);
+        // emitted on the render thread, while the textures can still be deleted
+        cache->invalidatedConnection = QObject::connect(window, &QQuickWindow::sceneGraphInvalidated, [this, window]() {
+            releaseRetained(window);
+        });
+    }
+    return cache;
+}
+
+void ImageTexturesCachePrivate::release(QWindow *window, const TextureKey &key, QSGTexture *texture)
+{
+    {
+        QMutexLocker locker(&mutex);
+        const QSharedPointer<WindowTexturesCache> cache = windows.value(window);
+        if (cache) {
+            QMutexLocker windowLocker(&cache->mutex);
+            // the entry may already point to a newer texture for the same image
+            if (cache->textures.value(key).isNull()) {
+                cache->textures.remove(key);
+                if (!cache->textures.contains(qMakePair(key.first, !key.second))) {
+                    cache->images.remove(key.first);
+                }
+            }
+            if (cache->textures.isEmpty()) {
+                cache->detached = true;
+                QObject::disconnect(cache->invalidatedConnection);
+                windows.remove(window);
+            }
+        }
+    }
+    delete texture;
+}
+
+void ImageTexturesCachePrivate::releaseRetained(QWindow *window)
+{
+    TextureList dropped;
+    QMutexLocker locker(&mutex);
+    const QSharedPointer<WindowTexturesCache> cache = windows.value(window);
+    if (cache) {
+        QMutexLocker windowLocker(&cache->mutex);
+        evict(*cache, 0, dropped);
+    }
+    locker.unlock();
+}
+
+void ImageTexturesCachePrivate::retain(WindowTexturesCache &cache, const TextureKey &key, const QSharedPointer<QSGTexture> &texture, TextureList &dropped)
+{
+    const qint64 currentBudget = budget.load();
+    auto it = cache.retained.find(key);
+    if (it != cache.retained.end()) {
+        cache.lru.splice(cache.lru.end(), cache.lru, it->lruPosition);
+    } else if (currentBudget > 0) {
+        const QSize size = texture->textureSize();
+        const qint64 bytes = qint64(size.width()) * size.height() * 4;
+        if (bytes <= currentBudget) {
+            cache.lru.push_back(key);
+            cache.retained.insert(key, {texture, bytes, std::prev(cache.lru.end())});
+            cache.statistics.retainedBytes += bytes;
+            ++cache.statistics.retainedTextures;
+        }
+    }
+
+    const int evicted = evict(cache, currentBudget, dropped);
+    cache.statistics.evictions += evicted;
+    evictions += evicted;
+}
+
+int ImageTexturesCachePrivate::evict(WindowTexturesCache &cache, qint64 limit, TextureList &dropped)
+{
+    int evicted = 0;
+    while (cache.statistics.retainedBytes > limit && !cache.lru.empty()) {
+        const WindowTexturesCache::RetainedTexture entry = cache.retained.take(cache.lru.front());
+        cache.lru.pop_front();
+        cache.statistics.retainedBytes -= entry.bytes;
+        --cache.statistics.retainedTextures;
+        dropped << entry.texture;
+        ++evicted;
+    }
+    return evicted;
+}
+
 ImageTexturesCache::ImageTexturesCache()
     : d(new ImageTexturesCachePrivate)
 {
@@ -22,30 +170,74 @@ ImageTexturesCache::ImageTexturesCache()
 
 ImageTexturesCache::~ImageTexturesCache()
 {
+    // the retained textures have to go while their deleter can still reach us
+    TextureList dropped;
+    QMutexLocker locker(&d->mutex);
+    for (const QSharedPointer<WindowTexturesCache> &cache : qAsConst(d->windows)) {
+        QMutexLocker windowLocker(&cache->mutex);
+        QObject::disconnect(cache->invalidatedConnection);
+        d->evict(*cache, 0, dropped);
+    }
+    locker.unlock();
 }
 
 QSharedPointer<QSGTexture> ImageTexturesCache::loadTexture(QQuickWindow *window, const QImage &image, QQuickWindow::CreateTextureOptions options)
 {
-    qint64 id = image.cacheKey();
-    QSharedPointer<QSGTexture> texture = d->cache.value(id).value(window).toStrongRef();
+    const bool contentAddressed = d->contentAddressed;
+    qint64 id = contentAddressed ? contentKey(image) : image.cacheKey();
+    QSharedPointer<QSGTexture> texture;
+    // declared before the locks, so these get released after them
+    QSharedPointer<QSGTexture> cached;
+    TextureList dropped;
 
-    if (!texture) {
-        auto cleanAndDelete = [this, window, id](QSGTexture* texture) {
-            QHash<QWindow*, QWeakPointer<QSGTexture> >& textures = (d->cache)[id];
-            textures.remove(window);
-            if (textures.isEmpty())
-                d->cache.remove(id);
-            delete texture;
-        };
-        texture = QSharedPointer<QSGTexture>(window->createTextureFromImage(image, options), cleanAndDelete);
-        (d->cache)[id][window] = texture.toWeakRef();
-    }
+    for (;;) {
+        const QSharedPointer<WindowTexturesCache> cache = d->windowCache(window);
+        QMutexLocker locker(&cache->mutex);
+        if (cache->detached) {
+            // emptied and dropped by another thread in the meantime
+            continue;
+        }
 
-    //if we have a cache in an atlas but our request cannot use an atlassed texture
-    //create a new texture and use that
-    //don't use removedFromAtlas() as that requires keeping a reference to the non atlased version
-    if (!(options & QQuickWindow::TextureCanUseAtlas) && texture->isAtlasTexture()) {
-        texture = QSharedPointer<QSGTexture>(window->createTextureFromImage(image, options));
+        // a standalone texture fits any request, an atlassed one only those allowing it
+        if (options & QQuickWindow::TextureCanUseAtlas) {
+            cached = cache->textures.value(qMakePair(id, true)).toStrongRef();
+        }
+        if (!cached) {
+            cached = cache->textures.value(qMakePair(id, false)).toStrongRef();
+        }
+        if (cached && contentAddressed && cache->images.value(id) != image) {
+            // a different image with the same hash, don't share its texture
+            texture = QSharedPointer<QSGTexture>(window->createTextureFromImage(image, options));
+            ++cache->statistics.misses;
+            ++cache->statistics.uploads;
+            ++d->misses;
+            ++d->uploads;
+            break;
+        }
+
+        if (cached) {
+            ++cache->statistics.hits;
+            ++d->hits;
+        } else {
+            QSGTexture *newTexture = window->createTextureFromImage(image, options);
+            const TextureKey key(id, newTexture->isAtlasTexture());
+            ImageTexturesCachePrivate *priv = d.data();
+            auto cleanAndDelete = [priv, window, key](QSGTexture* texture) {
+                priv->release(window, key, texture);
+            };
+            cached = QSharedPointer<QSGTexture>(newTexture, cleanAndDelete);
+            cache->textures[key] = cached.toWeakRef();
+            if (contentAddressed) {
+                cache->images[id] = image;
+            }
+            ++cache->statistics.misses;
+            ++cache->statistics.uploads;
+            ++d->misses;
+            ++d->uploads;
+        }
+        d->retain(*cache, qMakePair(id, cached->isAtlasTexture()), cached, dropped);
+        texture = cached;
+        break;
     }
 
     return texture;
@@ -53,5 +245,87 @@ QSharedPointer<QSGTexture> ImageTexturesCache::loadTexture(QQuickWindow *window,
 
 QSharedPointer<QSGTexture> ImageTexturesCache::loadTexture(QQuickWindow *window, const QImage &image)
 {
-    return loadTexture(window, image, QQuickWindow::CreateTextureOptions());
+    QQuickWindow::CreateTextureOptions options;
+    const int limit = d->atlasSizeLimit;
+    if (limit > 0 && image.width() <= limit && image.height() <= limit) {
+        options |= QQuickWindow::TextureCanUseAtlas;
+    }
+    return loadTexture(window, image, options);
+}
+
+void ImageTexturesCache::setAtlasSizeLimit(int pixels)
+{
+    d->atlasSizeLimit = qMax(0, pixels);
+}
+
+int ImageTexturesCache::atlasSizeLimit() const
+{
+    return d->atlasSizeLimit;
+}
+
+void ImageTexturesCache::setContentAddressed(bool contentAddressed)
+{
+    d->contentAddressed = contentAddressed;
+}
+
+bool ImageTexturesCache::isContentAddressed() const
+{
+    return d->contentAddressed;
+}
+
+void ImageTexturesCache::setRetentionBudget(qint64 bytes)
+{
+    d->budget = qMax<qint64>(0, bytes);
+}
+
+qint64 ImageTexturesCache::retentionBudget() const
+{
+    return d->budget;
+}
+
+ImageTexturesCache::Statistics ImageTexturesCache::statistics() const
+{
+    Statistics statistics;
+    statistics.hits = d->hits;
+    statistics.misses = d->misses;
+    statistics.uploads = d->uploads;
+    statistics.evictions = d->evictions;
+
+    QMutexLocker locker(&d->mutex);
+    for (const QSharedPointer<WindowTexturesCache> &cache : qAsConst(d->windows)) {
+        QMutexLocker windowLocker(&cache->mutex);
+        statistics.retainedBytes += cache->statistics.retainedBytes;
+        statistics.retainedTextures += cache->statistics.retainedTextures;
+    }
+    return statistics;
+}
+
+ImageTexturesCache::Statistics ImageTexturesCache::statistics(QWindow *window) const
+{
+    QMutexLocker locker(&d->mutex);
+    const QSharedPointer<WindowTexturesCache> cache = d->windows.value(window);
+    if (!cache) {
+        return Statistics();
+    }
+
+    QMutexLocker windowLocker(&cache->mutex);
+    return cache->statistics;
+}
+
+void ImageTexturesCache::resetStatistics()
+{
+    d->hits = 0;
+    d->misses = 0;
+    d->uploads = 0;
+    d->evictions = 0;
+
+    QMutexLocker locker(&d->mutex);
+    for (const QSharedPointer<WindowTexturesCache> &cache : qAsConst(d->windows)) {
+        QMutexLocker windowLocker(&cache->mutex);
+        Statistics &statistics = cache->statistics;
+        statistics.hits = 0;
+        statistics.misses = 0;
+        statistics.uploads = 0;
+        statistics.evictions = 0;
+    }
 }
@@ -26,11 +26,33 @@ class ImageTexturesCachePrivate;
  * Keeps track of all the created textures in a map between the QImage::cacheKey() and
  * the cached texture until it gets de-referenced.
  *
+ * Textures can be loaded concurrently from the render threads of different
+ * windows, each window having its own sub-cache.
+ *
  * @see ManagedTextureNode
  */
 class QUICKADDONS_EXPORT ImageTexturesCache
 {
 public:
+    /**
+     * Counters describing how the cache performs
+     * @since 5.80
+     */
+    struct Statistics {
+        /// Requests served with an already existing texture
+        quint64 hits = 0;
+        /// Requests which needed a new texture
+        quint64 misses = 0;
+        /// Textures created out of an image
+        quint64 uploads = 0;
+        /// Textures dropped from the retention tier to stay within the budget
+        quint64 evictions = 0;
+        /// Estimated memory used by the textures kept by the retention tier
+        qint64 retainedBytes = 0;
+        /// Number of textures kept by the retention tier
+        int retainedTextures = 0;
+    };
+
     ImageTexturesCache();
     ~ImageTexturesCache();
 
@@ -39,11 +61,107 @@ public:
      *
      * If an @p image id is the same as one already provided before, we won't create
      * a new texture and return a shared pointer to the existing texture.
+     * An image can have both a texture in the atlas and a standalone one, the latter
+     * being used for requests without QQuickWindow::TextureCanUseAtlas.
      */
     QSharedPointer<QSGTexture> loadTexture(QQuickWindow *window, const QImage &image, QQuickWindow::CreateTextureOptions options);
 
+    /**
+     * @returns the texture for a given @p window and @p image.
+     *
+     * Images not larger than atlasSizeLimit() in both dimensions get a texture
+     * that can be packed in the atlas of the window, other images get a standalone
+     * texture.
+     */
     QSharedPointer<QSGTexture> loadTexture(QQuickWindow *window, const QImage &image);
 
+    /**
+     * Sets the size up to which loadTexture() without options lets images
+     * share the atlas texture of the window.
+     *
+     * Textures packed in the atlas can be drawn in a single batch, which makes
+     * views showing many small images such as icons much cheaper to render.
+     * Atlassed textures can't be repeated though, use the overload taking
+     * options to explicitly get a standalone texture.
+     *
+     * @param pixels the maximum width and height of an atlassed image,
+     *        0 (the default) to never use the atlas
+     * @since 5.80
+     */
+    void setAtlasSizeLimit(int pixels);
+
+    /**
+     * @returns the maximum width and height of images put in the atlas by loadTexture()
+     * @since 5.80
+     */
+    int atlasSizeLimit() const;
+
+    /**
+     * Sets whether textures are shared between images having the same content.
+     *
+     * By default textures are identified by QImage::cacheKey(), so two images
+     * with the same pixels but created separately, like the result of successive
+     * QIcon::pixmap() calls, get uploaded twice. In content addressed mode,
+     * textures are identified by a hash of the size, format and pixels of the image
+     * instead, so equal images share a single texture per window.
+     *
+     * This costs hashing and, for found textures, comparing the image, and the
+     * cache keeps a reference to the image of each of its textures.
+     *
+     * @param contentAddressed true to identify textures by their image content
+     * @since 5.80
+     */
+    void setContentAddressed(bool contentAddressed);
+
+    /**
+     * @returns whether textures are identified by the content of their image
+     * @since 5.80
+     */
+    bool isContentAddressed() const;
+
+    /**
+     * Sets the memory budget, in bytes, of the retention tier of each window.
+     *
+     * By default textures are deleted as soon as they are not referenced anymore,
+     * so an image that stops being shown and comes back has to be uploaded again.
+     * With a budget greater than 0, the most recently used textures are kept alive
+     * until they take more memory than the budget, the least recently used ones
+     * being evicted first.
+     *
+     * Textures are evicted from the render thread of their window, so lowering
+     * the budget takes effect on the next texture loaded for that window.
+     * Retained textures are released when the window's scene graph is invalidated.
+     *
+     * @param bytes the budget for each window, 0 to disable the retention tier
+     * @since 5.80
+     */
+    void setRetentionBudget(qint64 bytes);
+
+    /**
+     * @returns the memory budget of the retention tier of each window, in bytes
+     * @since 5.80
+     */
+    qint64 retentionBudget() const;
+
+    /**
+     * @returns the counters accumulated for all the windows
+     * @since 5.80
+     */
+    Statistics statistics() const;
+
+    /**
+     * @returns the counters of the given @p window, as long as the cache
+     * holds any of its textures
+     * @since 5.80
+     */
+    Statistics statistics(QWindow *window) const;
+
+    /**
+     * Resets the hit, miss, upload and eviction counters.
+     * @since 5.80
+     */
+    void resetStatistics();
+
 
 private:
     QScopedPointer<ImageTexturesCachePrivate> d;
@@ -7,12 +7,110 @@
 
 #include "managedconfigmodule.h"
 
+#include <QCoreApplication>
+#include <QMetaProperty>
+#include <QMutex>
 #include <QPointer>
+#include <QRunnable>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
 
+#include <KConfigCore/KConfigGroup>
 #include <KConfigCore/KCoreConfigSkeleton>
 
+#include <algorithm>
+#include <functional>
+
 namespace KQuickAddons {
 
+// property name to the index of its notify signal
+typedef QHash<QString, int> NotifySignals;
+typedef QHash<const QMetaObject *, NotifySignals> NotifySignalsCache;
+Q_GLOBAL_STATIC(NotifySignalsCache, s_notifySignals)
+static QMutex s_notifySignalsMutex;
+
+// Looking up properties by name scans them all, so they are indexed once per class.
+// Modules may be created from several threads, the cache is shared by all of them.
+static NotifySignals notifySignals(const QMetaObject *metaObject)
+{
+    QMutexLocker locker(&s_notifySignalsMutex);
+    auto it = s_notifySignals->constFind(metaObject);
+    if (it == s_notifySignals->constEnd()) {
+        NotifySignals notifiers;
+        for (int i = 0; i < metaObject->propertyCount(); ++i) {
+            const QMetaProperty property = metaObject->property(i);
+            if (property.hasNotifySignal()) {
+                notifiers.insert(QString::fromLatin1(property.name()), property.notifySignalIndex());
+            }
+        }
+        it = s_notifySignals->insert(metaObject, notifiers);
+    }
+    return it.value();
+}
+
+// What is known about the items of a registered skeleton, kept up to date one item at a time
+struct SkeletonState
+{
+    QPointer<KCoreConfigSkeleton> skeleton;
+    // notify signal index to the items it notifies about
+    QHash<int, QVector<KConfigSkeletonItem *>> signalItems;
+    // items which changed since the last evaluation
+    QSet<KConfigSkeletonItem *> pendingItems;
+    // items which differ from the saved, respectively the default, value
+    QSet<KConfigSkeletonItem *> unsavedItems;
+    QSet<KConfigSkeletonItem *> nonDefaultItems;
+};
+
+// Where a skeleton's configuration lives, so that a worker thread can open its own copy
+struct ConfigFile
+{
+    QString name;
+    KConfig::OpenFlags openFlags;
+    QStandardPaths::StandardLocation location;
+};
+
+typedef QVector<QSharedPointer<KConfig>> ConfigList;
+
+class FunctionRunnable : public QRunnable
+{
+public:
+    explicit FunctionRunnable(std::function<void()> function)
+        : m_function(std::move(function))
+    {
+    }
+
+    void run() override
+    {
+        m_function();
+    }
+
+private:
+    std::function<void()> m_function;
+};
+
+static ConfigList openConfigs(const QVector<ConfigFile> &files)
+{
+    ConfigList configs;
+    for (const ConfigFile &file : files) {
+        configs << QSharedPointer<KConfig>::create(file.name, file.openFlags, file.location);
+    }
+    return configs;
+}
+
+// Identifies an entry whatever the configuration object it is read from
+static QString entryId(KConfigSkeletonItem *item, KConfig *config)
+{
+    QStringList path(item->key());
+    KConfigGroup group = item->configGroup(config);
+    // top level groups are children of the unnamed root group
+    while (group.name() != QLatin1String("<default>")) {
+        path << group.name();
+        group = group.parent();
+    }
+    return path.join(QLatin1Char('\x1d'));
+}
+
 class ManagedConfigModulePrivate
 {
 public:
@@ -20,14 +118,278 @@ public:
         _q(module)
     {
         QMetaObject::invokeMethod(_q, "_k_registerSettings", Qt::QueuedConnection);
+        _ioPool.setMaxThreadCount(1);
     }
 
     void _k_registerSettings();
+    void _k_itemChanged();
+    void _k_evaluate();
+
+    void scheduleEvaluation();
+    void updateItem(SkeletonState &state, KConfigSkeletonItem *item);
+    void updateSkeleton(SkeletonState &state);
+
+    void collectSkeletons(QVector<QPointer<KCoreConfigSkeleton>> &skeletons, QVector<ConfigFile> &files) const;
+    void loadAsync();
+    void finishLoad(const QVector<QPointer<KCoreConfigSkeleton>> &skeletons, const ConfigList &parsed);
+    void saveAsync();
+    void writeItems(const QVector<QPointer<KCoreConfigSkeleton>> &skeletons, const QVector<ConfigFile> &files, const ConfigList &staging);
+    void finishSave(const QVector<QPointer<KCoreConfigSkeleton>> &skeletons,
+                    const QVector<QHash<QString, QVariant>> &written,
+                    const ConfigList &saved,
+                    bool success);
+
+    enum IoOperation {
+        Load,
+        Save
+    };
 
     ManagedConfigModule *_q;
     QList<QPointer<KCoreConfigSkeleton>> _skeletons;
+    // a single thread, so that loads and saves happen in order
+    QThreadPool _ioPool;
+    bool _asynchronous = false;
+    // a save is parsed, written and synced in turns, the loads and saves
+    // requested meanwhile run once it is finished
+    bool _saving = false;
+    QVector<IoOperation> _deferredOperations;
+    QHash<const QObject *, SkeletonState> _states;
+    bool _evaluationScheduled = false;
 };
 
+void ManagedConfigModulePrivate::scheduleEvaluation()
+{
+    // all the changes of an event loop iteration are evaluated at once
+    if (!_evaluationScheduled) {
+        _evaluationScheduled = true;
+        QMetaObject::invokeMethod(_q, "_k_evaluate", Qt::QueuedConnection);
+    }
+}
+
+void ManagedConfigModulePrivate::updateItem(SkeletonState &state, KConfigSkeletonItem *item)
+{
+    if (item->isSaveNeeded()) {
+        state.unsavedItems.insert(item);
+    } else {
+        state.unsavedItems.remove(item);
+    }
+
+    if (item->isDefault()) {
+        state.nonDefaultItems.remove(item);
+    } else {
+        state.nonDefaultItems.insert(item);
+    }
+}
+
+void ManagedConfigModulePrivate::updateSkeleton(SkeletonState &state)
+{
+    state.pendingItems.clear();
+    state.unsavedItems.clear();
+    state.nonDefaultItems.clear();
+    if (!state.skeleton) {
+        return;
+    }
+
+    const auto items = state.skeleton->items();
+    for (auto item : items) {
+        updateItem(state, item);
+    }
+}
+
+void ManagedConfigModulePrivate::_k_itemChanged()
+{
+    const auto it = _states.find(_q->sender());
+    if (it == _states.end()) {
+        return;
+    }
+
+    SkeletonState &state = it.value();
+    for (auto item : state.signalItems.value(_q->senderSignalIndex())) {
+        state.pendingItems.insert(item);
+    }
+    scheduleEvaluation();
+}
+
+void ManagedConfigModulePrivate::_k_evaluate()
+{
+    _evaluationScheduled = false;
+
+    bool needsSave = false;
+    bool representsDefaults = true;
+    for (auto it = _states.begin(); it != _states.end(); ++it) {
+        SkeletonState &state = it.value();
+        for (auto item : qAsConst(state.pendingItems)) {
+            updateItem(state, item);
+        }
+        state.pendingItems.clear();
+
+        needsSave |= !state.unsavedItems.isEmpty();
+        representsDefaults &= state.nonDefaultItems.isEmpty();
+    }
+
+    if (!needsSave) {
+        needsSave = _q->isSaveNeeded();
+    }
+
+    if (representsDefaults) {
+        representsDefaults = _q->isDefaults();
+    }
+
+    _q->setRepresentsDefaults(representsDefaults);
+    _q->setNeedsSave(needsSave);
+}
+
+void ManagedConfigModulePrivate::collectSkeletons(QVector<QPointer<KCoreConfigSkeleton>> &skeletons, QVector<ConfigFile> &files) const
+{
+    for (const auto &skeleton : qAsConst(_skeletons)) {
+        if (skeleton) {
+            const KConfig *config = skeleton->config();
+            skeletons << skeleton;
+            files.append({config->name(), config->openFlags(), config->locationType()});
+        }
+    }
+}
+
+void ManagedConfigModulePrivate::loadAsync()
+{
+    // a save spans several jobs, what comes after it waits for it to be done
+    if (_saving) {
+        _deferredOperations << Load;
+        return;
+    }
+
+    // parsing the files is the expensive part, it happens on the worker
+    QVector<QPointer<KCoreConfigSkeleton>> skeletons;
+    QVector<ConfigFile> files;
+    collectSkeletons(skeletons, files);
+
+    QPointer<ManagedConfigModule> module = _q;
+    _ioPool.start(new FunctionRunnable([module, skeletons, files]() {
+        const ConfigList parsed = openConfigs(files);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [module, skeletons, parsed]() {
+            if (module) {
+                module->d->finishLoad(skeletons, parsed);
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void ManagedConfigModulePrivate::finishLoad(const QVector<QPointer<KCoreConfigSkeleton>> &skeletons, const ConfigList &parsed)
+{
+    for (int i = 0; i < skeletons.count(); ++i) {
+        KCoreConfigSkeleton *skeleton = skeletons.at(i);
+        if (!skeleton) {
+            continue;
+        }
+        const auto items = skeleton->items();
+        for (auto item : items) {
+            item->readConfig(parsed.at(i).data());
+        }
+        Q_EMIT skeleton->configChanged();
+    }
+    Q_EMIT _q->loadFinished();
+}
+
+void ManagedConfigModulePrivate::saveAsync()
+{
+    if (_saving) {
+        _deferredOperations << Save;
+        return;
+    }
+    _saving = true;
+
+    // the files are parsed on the worker, the items write into them on the GUI thread, the worker syncs them
+    QVector<QPointer<KCoreConfigSkeleton>> skeletons;
+    QVector<ConfigFile> files;
+    collectSkeletons(skeletons, files);
+
+    QPointer<ManagedConfigModule> module = _q;
+    _ioPool.start(new FunctionRunnable([module, skeletons, files]() {
+        const ConfigList staging = openConfigs(files);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [module, skeletons, files, staging]() {
+            if (module) {
+                module->d->writeItems(skeletons, files, staging);
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void ManagedConfigModulePrivate::writeItems(const QVector<QPointer<KCoreConfigSkeleton>> &skeletons,
+                                            const QVector<ConfigFile> &files,
+                                            const ConfigList &staging)
+{
+    // the values written, by entry, to tell apart the items changed in the meantime
+    QVector<QHash<QString, QVariant>> written(skeletons.count());
+    for (int i = 0; i < skeletons.count(); ++i) {
+        KCoreConfigSkeleton *skeleton = skeletons.at(i);
+        if (!skeleton) {
+            continue;
+        }
+        KConfig *config = staging.at(i).data();
+        const auto items = skeleton->items();
+        for (auto item : items) {
+            // as for a synchronous save, only the changed items write, with their own encoding
+            if (item->isSaveNeeded()) {
+                item->writeConfig(config);
+                written[i].insert(entryId(item, config), item->property());
+            }
+        }
+    }
+
+    QPointer<ManagedConfigModule> module = _q;
+    _ioPool.start(new FunctionRunnable([module, skeletons, files, staging, written]() {
+        bool success = true;
+        for (const auto &config : staging) {
+            success &= config->sync();
+        }
+        // what the items read back, parsed here rather than on the GUI thread
+        const ConfigList saved = openConfigs(files);
+
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [module, skeletons, written, saved, success]() {
+            if (module) {
+                module->d->finishSave(skeletons, written, saved, success);
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void ManagedConfigModulePrivate::finishSave(const QVector<QPointer<KCoreConfigSkeleton>> &skeletons,
+                                            const QVector<QHash<QString, QVariant>> &written,
+                                            const ConfigList &saved,
+                                            bool success)
+{
+    for (int i = 0; i < skeletons.count(); ++i) {
+        KCoreConfigSkeleton *skeleton = skeletons.at(i);
+        if (!skeleton) {
+            continue;
+        }
+        KConfig *config = saved.at(i).data();
+        const auto items = skeleton->items();
+        for (auto item : items) {
+            const auto it = written.at(i).constFind(entryId(item, config));
+            // values changed in the meantime remain to be saved
+            if (it != written.at(i).constEnd() && item->property() == it.value()) {
+                item->readConfig(config);
+            }
+        }
+        Q_EMIT skeleton->configChanged();
+    }
+
+    _saving = false;
+    Q_EMIT _q->saveFinished(success);
+
+    // in the order they were requested, a further save defers the ones after it again
+    const QVector<IoOperation> operations = _deferredOperations;
+    _deferredOperations.clear();
+    for (IoOperation operation : operations) {
+        if (operation == Load) {
+            loadAsync();
+        } else {
+            saveAsync();
+        }
+    }
+}
+
 ManagedConfigModule::ManagedConfigModule(const KAboutData *aboutData, QObject *parent, const QVariantList &args)
     : ConfigModule(aboutData, parent, args),
       d(new ManagedConfigModulePrivate(this))
@@ -53,6 +415,11 @@ ManagedConfigModule::~ManagedConfigModule()
 
 void ManagedConfigModule::load()
 {
+    if (d->_asynchronous) {
+        d->loadAsync();
+        return;
+    }
+
     for (const auto &skeleton : qAsConst(d->_skeletons)) {
         if (skeleton) {
             skeleton->load();
@@ -62,6 +429,11 @@ void ManagedConfigModule::load()
 
 void ManagedConfigModule::save()
 {
+    if (d->_asynchronous) {
+        d->saveAsync();
+        return;
+    }
+
     for (const auto &skeleton : qAsConst(d->_skeletons)) {
         if (skeleton) {
             skeleton->save();
@@ -74,8 +446,21 @@ void ManagedConfigModule::defaults()
     for (const auto &skeleton : qAsConst(d->_skeletons)) {
         if (skeleton) {
             skeleton->setDefaults();
+            // unlike loading and saving, this doesn't emit configChanged
+            d->updateSkeleton(d->_states[skeleton]);
         }
     }
+    d->scheduleEvaluation();
+}
+
+void ManagedConfigModule::setAsynchronous(bool asynchronous)
+{
+    d->_asynchronous = asynchronous;
+}
+
+bool ManagedConfigModule::isAsynchronous() const
+{
+    return d->_asynchronous;
 }
 
 bool ManagedConfigModule::isSaveNeeded() const
@@ -98,25 +483,10 @@ void ManagedConfigModulePrivate::_k_registerSettings()
 
 void ManagedConfigModule::settingsChanged()
 {
-    bool needsSave = false;
-    bool representsDefaults = true;
-    for (const auto &skeleton : qAsConst(d->_skeletons)) {
-        if (skeleton) {
-            needsSave |= skeleton->isSaveNeeded();
-            representsDefaults &= skeleton->isDefaults();
-        }
-    }
-
-    if (!needsSave) {
-        needsSave = isSaveNeeded();
-    }
-
-    if (representsDefaults) {
-        representsDefaults = isDefaults();
+    for (auto it = d->_states.begin(); it != d->_states.end(); ++it) {
+        d->updateSkeleton(it.value());
     }
-
-    setRepresentsDefaults(representsDefaults);
-    setNeedsSave(needsSave);
+    d->_k_evaluate();
 }
 
 void ManagedConfigModule::registerSettings(KCoreConfigSkeleton *skeleton)
@@ -126,41 +496,52 @@ void ManagedConfigModule::registerSettings(KCoreConfigSkeleton *skeleton)
     }
 
     d->_skeletons.append(skeleton);
-
-    auto settingsChangedSlotIndex = metaObject()->indexOfMethod("settingsChanged()");
-    auto settingsChangedSlot = metaObject()->method(settingsChangedSlotIndex);
-
-    QObject::connect(skeleton, &KCoreConfigSkeleton::configChanged, this, &ManagedConfigModule::settingsChanged);
+    SkeletonState &state = d->_states[skeleton];
+    state.skeleton = skeleton;
+
+    // loading, saving and resetting may touch any item
+    QObject::connect(skeleton, &KCoreConfigSkeleton::configChanged, this, [this, skeleton]() {
+        d->updateSkeleton(d->_states[skeleton]);
+        d->scheduleEvaluation();
+    });
+    QObject::connect(skeleton, &QObject::destroyed, this, [this](QObject *object) {
+        d->_states.remove(object);
+        d->scheduleEvaluation();
+    });
+
+    // Setters of generated skeletons only emit the notify signal of their property,
+    // configChanged() is left to load and save: each signal needs its own connection.
+    // Items sharing a signal share the connection.
+    const QMetaObject *skeletonMetaObject = skeleton->metaObject();
+    const auto itemChangedSlot = metaObject()->method(metaObject()->indexOfMethod("_k_itemChanged()"));
+    const NotifySignals notifiers = notifySignals(skeletonMetaObject);
 
     const auto items = skeleton->items();
     for (auto item : items) {
-        const auto itemHasSignals = dynamic_cast<KConfigCompilerSignallingItem*>(item) || dynamic_cast<KPropertySkeletonItem*>(item);
-        if (!itemHasSignals) {
-            continue;
-        }
-
         auto name = item->name();
-        if (name.at(0).isUpper()) {
+        if (!name.isEmpty() && name.at(0).isUpper()) {
             name[0] = name[0].toLower();
         }
 
-        const auto metaObject = skeleton->metaObject();
-        const auto propertyIndex = metaObject->indexOfProperty(name.toUtf8().constData());
-        const auto property = metaObject->property(propertyIndex);
-        if (!property.hasNotifySignal()) {
+        const int signalIndex = notifiers.value(name, -1);
+        if (signalIndex == -1) {
             continue;
         }
 
-        const auto changedSignal = property.notifySignal();
-        QObject::connect(skeleton, changedSignal, this, settingsChangedSlot);
+        QVector<KConfigSkeletonItem *> &signalItems = state.signalItems[signalIndex];
+        if (signalItems.isEmpty()) {
+            QObject::connect(skeleton, skeletonMetaObject->method(signalIndex), this, itemChangedSlot);
+        }
+        signalItems << item;
     }
+    d->updateSkeleton(state);
 
     auto toRemove = std::remove_if(d->_skeletons.begin(),
                                    d->_skeletons.end(),
                                    [](const QPointer<KCoreConfigSkeleton> &value) { return value.isNull(); } );
     d->_skeletons.erase(toRemove, d->_skeletons.end());
 
-    QMetaObject::invokeMethod(this, "settingsChanged", Qt::QueuedConnection);
+    d->scheduleEvaluation();
 }
 
 }
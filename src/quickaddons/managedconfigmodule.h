@@ -134,6 +134,45 @@ public:
      */
     ~ManagedConfigModule();
 
+    /**
+     * Sets whether load() and save() do their file I/O on a worker thread.
+     *
+     * When asynchronous, save() parses the configuration files on a worker thread,
+     * lets the changed items write their values into the result, then syncs it
+     * to disk and parses it again on the worker thread for the items to read.
+     * load() parses the configuration files on a worker thread, the items read
+     * the result. Loads and saves requested during a save run once it is done.
+     * loadFinished() and saveFinished() are emitted once done.
+     *
+     * The custom code of the settings objects, usrRead() and usrSave(), doesn't run
+     * in this mode, and the KConfig objects of the settings objects aren't parsed
+     * again: call reparseConfiguration() on them to read them directly.
+     * By default this is false, the I/O is synchronous.
+     *
+     * @since 5.80
+     */
+    void setAsynchronous(bool asynchronous);
+
+    /**
+     * @returns whether load() and save() do their file I/O on a worker thread
+     * @since 5.80
+     */
+    bool isAsynchronous() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted when an asynchronous load() finished
+     * @since 5.80
+     */
+    void loadFinished();
+
+    /**
+     * Emitted when an asynchronous save() finished
+     * @param success false if some configuration could not be written
+     * @since 5.80
+     */
+    void saveFinished(bool success);
+
 public Q_SLOTS:
     /**
      * Load the configuration data into the module.
@@ -179,6 +218,9 @@ protected Q_SLOTS:
      *
      * This is required for some modules which might have
      * some settings managed outside of KConfigXT objects.
+     *
+     * Changes of the items of registered settings don't need it, since 5.80
+     * they are tracked item by item and evaluated once per event loop iteration.
      */
     void settingsChanged();
 
@@ -211,6 +253,8 @@ private:
     virtual bool isDefaults() const;
 
     Q_PRIVATE_SLOT(d, void _k_registerSettings())
+    Q_PRIVATE_SLOT(d, void _k_itemChanged())
+    Q_PRIVATE_SLOT(d, void _k_evaluate())
     ManagedConfigModulePrivate *const d;
     friend class ManagedConfigModulePrivate;
 };
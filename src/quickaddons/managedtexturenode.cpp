@@ -6,6 +6,8 @@
 
 #include "managedtexturenode.h"
 
+#include <QSGTextureMaterial>
+
 ManagedTextureNode::ManagedTextureNode()
 {}
 
@@ -14,3 +16,16 @@ void ManagedTextureNode::setTexture(QSharedPointer<QSGTexture> texture)
     m_texture = texture;
     QSGSimpleTextureNode::setTexture(texture.data());
 }
+
+void ManagedTextureNode::setWrapMode(QSGTexture::WrapMode horizontal, QSGTexture::WrapMode vertical)
+{
+    // QSGSimpleTextureNode uses both materials, depending on the opacity
+    for (QSGMaterial *material : {this->material(), opaqueMaterial()}) {
+        QSGOpaqueTextureMaterial *textureMaterial = static_cast<QSGOpaqueTextureMaterial *>(material);
+        if (textureMaterial->horizontalWrapMode() != horizontal || textureMaterial->verticalWrapMode() != vertical) {
+            textureMaterial->setHorizontalWrapMode(horizontal);
+            textureMaterial->setVerticalWrapMode(vertical);
+            markDirty(DirtyMaterial);
+        }
+    }
+}
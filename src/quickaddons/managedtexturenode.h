@@ -37,6 +37,18 @@ public:
 
     void setTexture(QSharedPointer<QSGTexture> texture);
 
+    /**
+     * Sets how the texture is sampled outside of its bounds, for instance
+     * QSGTexture::Repeat to tile it with a source rect larger than the texture.
+     *
+     * The wrap mode is a property of the node, not of the texture,
+     * so it doesn't affect other nodes sharing the same texture.
+     * Atlassed textures can't be repeated.
+     *
+     * @since 5.80
+     */
+    void setWrapMode(QSGTexture::WrapMode horizontal, QSGTexture::WrapMode vertical);
+
 private:
     QSharedPointer<QSGTexture> m_texture;
 };
@@ -14,12 +14,224 @@
 #include <QVersionNumber>
 #include <QGuiApplication>
 #include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOffscreenSurface>
+#include <QLoggingCategory>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <KConfig>
+#include <KConfigGroup>
+
+Q_LOGGING_CATEGORY(QTQUICKSETTINGS, "kf.quickaddons.qtquicksettings", QtWarningMsg)
+
+/**
+ * Sets the environment variable @p name to @p value, unless the user set it already
+ */
+static void setDefaultEnvironment(const char *name, const QByteArray &value)
+{
+    if (!qEnvironmentVariableIsSet(name)) {
+        qputenv(name, value);
+    }
+}
+
+#ifndef GL_MAX_SAMPLES
+#define GL_MAX_SAMPLES 0x8D57
+#endif
+
+using KQuickAddons::QtQuickSettings::GraphicsCapabilities;
+
+// the capabilities are shared by all the applications of the session
+static const QString s_capabilitiesCacheFile = QStringLiteral("kquickaddons_glcapabilities");
+// how long after startup the cached capabilities are probed again
+static const int s_revalidationDelay = 5000;
+
+static QMutex s_capabilitiesMutex;
+static GraphicsCapabilities s_capabilities;
+
+static void setCapabilities(const GraphicsCapabilities &capabilities)
+{
+    QMutexLocker locker(&s_capabilitiesMutex);
+    s_capabilities = capabilities;
+}
+
+/**
+ * The GPUs of the machine and their kernel drivers, as "vendor:device:driver"
+ */
+static QStringList drmDevices()
+{
+    QStringList devices;
+    const QDir drm(QStringLiteral("/sys/class/drm"));
+    const QStringList cards = drm.entryList({QStringLiteral("card*")}, QDir::Dirs | QDir::System | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString &card : cards) {
+        // connectors are listed as card0-HDMI-A-1 and so on
+        if (card.contains(QLatin1Char('-'))) {
+            continue;
+        }
+        const QString devicePath = drm.filePath(card) + QStringLiteral("/device/");
+        QString device;
+        for (const QString &file : {QStringLiteral("vendor"), QStringLiteral("device")}) {
+            QFile idFile(devicePath + file);
+            if (idFile.open(QIODevice::ReadOnly)) {
+                device += QString::fromLatin1(idFile.readAll().trimmed());
+            }
+            device += QLatin1Char(':');
+        }
+        device += QFileInfo(QFileInfo(devicePath + QStringLiteral("driver")).symLinkTarget()).fileName();
+        devices << device;
+    }
+    return devices;
+}
+
+/**
+ * Identifies the configuration the capabilities were probed with. The driver
+ * can't be told without a GL context, so what selects it is part of the key:
+ * the host and display, which differ for shared homes and remote sessions, the GPUs
+ * and their kernel drivers, and the environment. The renderer reported by the
+ * driver is checked again by the revalidation.
+ */
+static QString capabilitiesKey()
+{
+    QStringList key{qApp->platformName(), QString::fromLatin1(qVersion()), QSysInfo::machineHostName()};
+    for (const char *name : {"DISPLAY", "WAYLAND_DISPLAY", "QT_XCB_GL_INTEGRATION", "QT_OPENGL", "LIBGL_ALWAYS_SOFTWARE", "MESA_LOADER_DRIVER_OVERRIDE", "__GLX_VENDOR_LIBRARY_NAME"}) {
+        key << qEnvironmentVariable(name);
+    }
+    key << drmDevices();
+    return key.join(QLatin1Char(' '));
+}
+
+static bool readCapabilities(const QString &key, GraphicsCapabilities &capabilities)
+{
+    KConfig config(s_capabilitiesCacheFile, KConfig::SimpleConfig, QStandardPaths::GenericCacheLocation);
+    const KConfigGroup group = config.group(key);
+    if (!group.exists()) {
+        return false;
+    }
+
+    capabilities.valid = true;
+    capabilities.openGLSupported = group.readEntry("OpenGLSupported", false);
+    capabilities.openGLES = group.readEntry("OpenGLES", false);
+    capabilities.majorVersion = group.readEntry("MajorVersion", 0);
+    capabilities.minorVersion = group.readEntry("MinorVersion", 0);
+    capabilities.multisampling = group.readEntry("Multisampling", false);
+    capabilities.maxSamples = group.readEntry("MaxSamples", 0);
+    capabilities.renderer = group.readEntry("Renderer", QString());
+    return true;
+}
+
+static void writeCapabilities(const QString &key, const GraphicsCapabilities &capabilities)
+{
+    KConfig config(s_capabilitiesCacheFile, KConfig::SimpleConfig, QStandardPaths::GenericCacheLocation);
+    KConfigGroup group = config.group(key);
+    group.writeEntry("OpenGLSupported", capabilities.openGLSupported);
+    group.writeEntry("OpenGLES", capabilities.openGLES);
+    group.writeEntry("MajorVersion", capabilities.majorVersion);
+    group.writeEntry("MinorVersion", capabilities.minorVersion);
+    group.writeEntry("Multisampling", capabilities.multisampling);
+    group.writeEntry("MaxSamples", capabilities.maxSamples);
+    group.writeEntry("Renderer", capabilities.renderer);
+    config.sync();
+}
+
+/**
+ * Creates a GL context to find out what the driver supports, the details
+ * beyond the version need the context to be made current on @p surface.
+ */
+static GraphicsCapabilities probeCapabilities(QOffscreenSurface *surface)
+{
+    GraphicsCapabilities capabilities;
+    capabilities.valid = true;
+
+    QOpenGLContext context;
+    if (!context.create()) {
+        return capabilities;
+    }
+
+    capabilities.openGLSupported = true;
+    capabilities.openGLES = context.isOpenGLES();
+    const QPair<int, int> version = context.format().version();
+    capabilities.majorVersion = version.first;
+    capabilities.minorVersion = version.second;
+
+    if (!surface->isValid() || !context.makeCurrent(surface)) {
+        return capabilities;
+    }
+
+    QOpenGLFunctions *gl = context.functions();
+    capabilities.renderer = QString::fromLatin1(reinterpret_cast<const char *>(gl->glGetString(GL_RENDERER)));
+    if (capabilities.openGLES) {
+        capabilities.multisampling = version >= qMakePair(3, 0) || context.hasExtension("GL_NV_framebuffer_multisample");
+    } else {
+        capabilities.multisampling = version >= qMakePair(3, 0) || context.hasExtension("GL_ARB_framebuffer_object") ||
+            context.hasExtension("GL_EXT_framebuffer_multisample");
+    }
+    if (capabilities.multisampling) {
+        gl->glGetIntegerv(GL_MAX_SAMPLES, &capabilities.maxSamples);
+    }
+    context.doneCurrent();
+
+    return capabilities;
+}
+
+class CapabilitiesProbe : public QRunnable
+{
+public:
+    CapabilitiesProbe(QOffscreenSurface *surface, const QString &key)
+        : m_surface(surface)
+        , m_key(key)
+    {
+    }
+
+    void run() override
+    {
+        const GraphicsCapabilities capabilities = probeCapabilities(m_surface);
+        // surfaces belong to the GUI thread
+        m_surface->deleteLater();
+        writeCapabilities(m_key, capabilities);
+        setCapabilities(capabilities);
+        qCDebug(QTQUICKSETTINGS) << "Revalidated OpenGL capabilities, renderer:" << capabilities.renderer;
+    }
+
+private:
+    QOffscreenSurface *m_surface;
+    const QString m_key;
+};
+
+/**
+ * Probes the capabilities again once the application is running, to catch
+ * driver updates. The new capabilities are used by later application starts.
+ */
+static void scheduleRevalidation(const QString &key)
+{
+    QTimer::singleShot(s_revalidationDelay, qApp, [key]() {
+        // surfaces can only be created on the GUI thread
+        QOffscreenSurface *surface = new QOffscreenSurface;
+        surface->create();
+        CapabilitiesProbe *probe = new CapabilitiesProbe(surface, key);
+        if (QOpenGLContext::supportsThreadedOpenGL()) {
+            QThreadPool::globalInstance()->start(probe);
+        } else {
+            probe->run();
+            delete probe;
+        }
+    });
+}
 
 /**
  * If QtQuick is configured (QQuickWindow::sceneGraphBackend()) to use the OpenGL backend,
  * check if it is supported or otherwise reconfigure QtQuick to fallback to software mode.
  * This function is called by init().
  *
+ * Creating a GL context is slow, so the outcome is cached per platform, Qt version,
+ * host, display and GPU, then checked again in the background.
+ *
  * @returns true if the selected backend is supported, false on fallback to software mode.
  */
 static bool checkBackend()
@@ -35,16 +247,32 @@ static bool checkBackend()
         return true;
     }
 
-    QOpenGLContext* gl = new QOpenGLContext();
-    bool ok = gl->create();
+    const QString key = capabilitiesKey();
+    GraphicsCapabilities capabilities;
+    if (readCapabilities(key, capabilities)) {
+        scheduleRevalidation(key);
+    } else {
+        QOffscreenSurface surface;
+        surface.create();
+        capabilities = probeCapabilities(&surface);
+        writeCapabilities(key, capabilities);
+    }
+    setCapabilities(capabilities);
+
+    const bool ok = capabilities.openGLSupported;
     if (!ok) {
         qWarning("Warning: fallback to QtQuick software backend.");
         QQuickWindow::setSceneGraphBackend(QStringLiteral("software"));
     }
-    delete gl;
     return ok;
 }
 
+GraphicsCapabilities KQuickAddons::QtQuickSettings::graphicsCapabilities()
+{
+    QMutexLocker locker(&s_capabilitiesMutex);
+    return s_capabilities;
+}
+
 void KQuickAddons::QtQuickSettings::init()
 {
     if (!(qobject_cast<QGuiApplication*>qApp)) {
@@ -53,8 +281,29 @@ void KQuickAddons::QtQuickSettings::init()
     }
 
     PlasmaQtQuickSettings::RendererSettings s;
-    if (!s.renderLoop().isEmpty() && !qEnvironmentVariableIsSet("QSG_RENDER_LOOP")) {
-        qputenv("QSG_RENDER_LOOP", s.renderLoop().toLatin1());
+    if (!s.renderLoop().isEmpty()) {
+        setDefaultEnvironment("QSG_RENDER_LOOP", s.renderLoop().toLatin1());
+    }
+
+    // read by QtQuick when the first window creates its renderer
+    if (s.atlasTextureSize() > 0) {
+        const QByteArray size = QByteArray::number(s.atlasTextureSize());
+        setDefaultEnvironment("QSG_ATLAS_WIDTH", size);
+        setDefaultEnvironment("QSG_ATLAS_HEIGHT", size);
+    }
+    if (s.batchNodeThreshold() > 0) {
+        setDefaultEnvironment("QSG_RENDERER_BATCH_NODE_THRESHOLD", QByteArray::number(s.batchNodeThreshold()));
+    }
+    if (s.batchVertexThreshold() > 0) {
+        setDefaultEnvironment("QSG_RENDERER_BATCH_VERTEX_THRESHOLD", QByteArray::number(s.batchVertexThreshold()));
+    }
+    // read when the first QML engine is created
+    if (!s.qmlDiskCache()) {
+        setDefaultEnvironment("QML_DISABLE_DISK_CACHE", "1");
+    }
+
+    if (!s.distanceFieldText()) {
+        QQuickWindow::setTextRenderType(QQuickWindow::NativeTextRendering);
     }
 
     if (!s.sceneGraphBackend().isEmpty()) {
@@ -76,5 +325,26 @@ void KQuickAddons::QtQuickSettings::init()
         QLibraryInfo::version() >= QVersionNumber(5, 13, 0)) {
         format.setOption(QSurfaceFormat::ResetNotification);
     }
+    if (s.swapInterval() >= 0) {
+        format.setSwapInterval(s.swapInterval());
+    }
+    if (s.samples() >= 0) {
+        format.setSamples(s.samples());
+    }
     QSurfaceFormat::setDefaultFormat(format);
+
+    qCDebug(QTQUICKSETTINGS) << "Scene graph backend:" << QQuickWindow::sceneGraphBackend()
+                             << "render loop:" << qgetenv("QSG_RENDER_LOOP")
+                             << "text rendering:" << QQuickWindow::textRenderType();
+    qCDebug(QTQUICKSETTINGS) << "Surface format:" << format;
+    const GraphicsCapabilities capabilities = graphicsCapabilities();
+    if (capabilities.valid) {
+        qCDebug(QTQUICKSETTINGS) << "OpenGL supported:" << capabilities.openGLSupported
+                                 << "version:" << capabilities.majorVersion << capabilities.minorVersion << (capabilities.openGLES ? "ES" : "")
+                                 << "max samples:" << capabilities.maxSamples
+                                 << "renderer:" << capabilities.renderer;
+    }
+    qCDebug(QTQUICKSETTINGS) << "Atlas:" << qgetenv("QSG_ATLAS_WIDTH") << "x" << qgetenv("QSG_ATLAS_HEIGHT")
+                             << "batch thresholds:" << qgetenv("QSG_RENDERER_BATCH_NODE_THRESHOLD") << qgetenv("QSG_RENDERER_BATCH_VERTEX_THRESHOLD")
+                             << "QML disk cache disabled:" << qgetenv("QML_DISABLE_DISK_CACHE");
 }
@@ -9,6 +9,8 @@
 
 #include "quickaddons_export.h"
 
+#include <QString>
+
 namespace KQuickAddons
 {
     /**
@@ -25,10 +27,53 @@ namespace KQuickAddons
      * This function must be called at the start of your application before any windows are created,
      * but after an instance of QGuiApplication is already available.
      *
+     * Since 5.80 the swap interval, multisampling, atlas size, batching thresholds,
+     * text rendering and QML disk cache can be configured as well. Settings applied
+     * through environment variables don't override variables set by the user.
+     * The effective configuration is logged in the kf.quickaddons.qtquicksettings category.
+     *
      * @since 5.26
      */
     QUICKADDONS_EXPORT void init();
 
+    /**
+     * What the OpenGL implementation supports, as found by init()
+     *
+     * @since 5.80
+     */
+    struct GraphicsCapabilities {
+        /**
+         * Whether the capabilities are known. They are not before init()
+         * is called, nor when QtQuick uses a backend other than OpenGL.
+         */
+        bool valid = false;
+        /** Whether a GL context can be created, QtQuick falls back to software otherwise */
+        bool openGLSupported = false;
+        bool openGLES = false;
+        int majorVersion = 0;
+        int minorVersion = 0;
+        /** Whether multisampled renderbuffers are supported */
+        bool multisampling = false;
+        /**
+         * GL_MAX_SAMPLES of the probed context, an upper bound: a given internal
+         * format or context profile may support fewer samples
+         */
+        int maxSamples = 0;
+        /** The renderer string reported by the driver */
+        QString renderer;
+    };
+
+    /**
+     * Returns the capabilities of the OpenGL implementation, so they don't
+     * need to be queried again. They are cached across application starts,
+     * and checked again in the background after startup.
+     *
+     * This function is thread-safe.
+     *
+     * @since 5.80
+     */
+    QUICKADDONS_EXPORT GraphicsCapabilities graphicsCapabilities();
+
     }
 }
 
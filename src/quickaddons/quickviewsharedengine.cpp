@@ -8,8 +8,10 @@
 #include "quickviewsharedengine.h"
 
 #include <QQmlEngine>
+#include <QQmlComponent>
 #include <QQmlContext>
 #include <QQuickItem>
+#include <QPointer>
 
 #include <KLocalizedString>
 #include <kdeclarative/qmlobjectsharedengine.h>
@@ -34,6 +36,7 @@ public:
                          q, SLOT(executionFinished()));
     }
 
+    void load();
     void executionFinished();
     void syncResizeMode();
     void syncWidth();
@@ -44,9 +47,62 @@ public:
     KDeclarative::QmlObjectSharedEngine *qmlObject;
     QuickViewSharedEngine::ResizeMode resizeMode;
     QSize initialSize;
-
+    QVariantHash initialProperties;
+    // what load() will instantiate, a component shared by clone() takes precedence over the url
+    QUrl pendingSource;
+    QPointer<QQmlComponent> pendingComponent;
+    bool loadingDeferred = false;
+    bool loadPending = false;
+    // creates the object with the initial properties once a loading component is ready
+    QMetaObject::Connection pendingInitialization;
+    bool initializationDelayed = false;
 };
 
+void QuickViewSharedEnginePrivate::load()
+{
+    loadPending = false;
+
+    if (pendingInitialization) {
+        QObject::disconnect(pendingInitialization);
+        qmlObject->setInitializationDelayed(initializationDelayed);
+    }
+
+    // hold back the automatic creation, so the initial properties are applied to it
+    initializationDelayed = qmlObject->isInitializationDelayed();
+    if (!initialProperties.isEmpty()) {
+        qmlObject->setInitializationDelayed(true);
+    }
+
+    if (pendingComponent) {
+        qmlObject->setMainComponent(pendingComponent);
+    } else {
+        qmlObject->setSource(pendingSource);
+    }
+    pendingComponent = nullptr;
+
+    if (initialProperties.isEmpty()) {
+        return;
+    }
+
+    QQmlComponent *component = qmlObject->mainComponent();
+    if (component && component->isLoading()) {
+        // connected before QmlObject waits for it too, so this runs first
+        pendingInitialization = QObject::connect(component, &QQmlComponent::statusChanged, q, [this](QQmlComponent::Status status) {
+            if (status == QQmlComponent::Loading) {
+                return;
+            }
+            QObject::disconnect(pendingInitialization);
+            qmlObject->setInitializationDelayed(initializationDelayed);
+            if (status == QQmlComponent::Ready) {
+                qmlObject->completeInitialization(initialProperties);
+            }
+        });
+    } else {
+        qmlObject->setInitializationDelayed(initializationDelayed);
+        qmlObject->completeInitialization(initialProperties);
+    }
+}
+
 void QuickViewSharedEnginePrivate::executionFinished()
 {
     if (!qmlObject->rootObject()) {
@@ -213,18 +269,79 @@ void QuickViewSharedEngine::setResizeMode(ResizeMode mode)
     d->syncResizeMode();
 }
 
+QuickViewSharedEngine *QuickViewSharedEngine::clone(QWindow *parent) const
+{
+    QuickViewSharedEngine *view = new QuickViewSharedEngine(parent);
+    view->setTranslationDomain(translationDomain());
+    view->setResizeMode(resizeMode());
+
+    view->setInitialProperties(initialProperties());
+    view->setLoadingDeferred(isLoadingDeferred());
+
+    view->d->pendingSource = source();
+    view->d->pendingComponent = d->qmlObject->mainComponent();
+    if (view->d->pendingComponent || d->loadPending) {
+        if (view->isLoadingDeferred()) {
+            view->d->loadPending = true;
+        } else {
+            view->d->load();
+        }
+    }
+
+    return view;
+}
+
+void QuickViewSharedEngine::setLoadingDeferred(bool deferred)
+{
+    d->loadingDeferred = deferred;
+    if (!deferred) {
+        preload();
+    }
+}
+
+bool QuickViewSharedEngine::isLoadingDeferred() const
+{
+    return d->loadingDeferred;
+}
+
+void QuickViewSharedEngine::setInitialProperties(const QVariantHash &initialProperties)
+{
+    d->initialProperties = initialProperties;
+}
+
+QVariantHash QuickViewSharedEngine::initialProperties() const
+{
+    return d->initialProperties;
+}
+
 void QuickViewSharedEngine::setSource(const QUrl &url)
 {
-    if (d->qmlObject->source() == url) {
+    if (source() == url) {
         return;
     }
 
-    d->qmlObject->setSource(url);
+    d->pendingSource = url;
+    d->pendingComponent = nullptr;
+    if (d->loadingDeferred && !isExposed()) {
+        d->loadPending = true;
+    } else {
+        d->load();
+    }
     Q_EMIT sourceChanged(url);
 }
 
+void QuickViewSharedEngine::preload()
+{
+    if (d->loadPending) {
+        d->load();
+    }
+}
+
 QUrl QuickViewSharedEngine::source() const
 {
+    if (d->loadPending) {
+        return d->pendingSource;
+    }
     return d->qmlObject->source();
 }
 
@@ -247,6 +364,15 @@ void QuickViewSharedEngine::resizeEvent(QResizeEvent *e)
     QQuickWindow::resizeEvent(e);
 }
 
+void QuickViewSharedEngine::exposeEvent(QExposeEvent *e)
+{
+    if (isExposed()) {
+        preload();
+    }
+
+    QQuickWindow::exposeEvent(e);
+}
+
 }
 
 #include "moc_quickviewsharedengine.cpp"
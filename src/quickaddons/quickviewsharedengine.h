@@ -81,12 +81,74 @@ public:
     ResizeMode resizeMode() const;
     void setResizeMode(ResizeMode);
 
+    /**
+     * Creates a new view showing another instance of the QML loaded in this view.
+     *
+     * The already compiled component of this view is reused, so only the new
+     * object tree gets instantiated. This is meant for windows showing the same
+     * source several times, such as per-screen panels.
+     * The resize mode and translation domain are copied to the new view.
+     *
+     * @param parent the parent window of the new view
+     * @return a new view, owned by the caller
+     * @since 5.80
+     */
+    QuickViewSharedEngine *clone(QWindow *parent = nullptr) const;
+
+    /**
+     * Sets whether loading the source is deferred until the window gets
+     * exposed for the first time, or until preload() is called.
+     *
+     * This avoids creating the QML of windows which are created upfront but
+     * may never be shown, such as popups or tooltips.
+     * While the first source is pending, rootObject() is nullptr and status() is
+     * QQmlComponent::Null. A source set once another one was loaded doesn't clear
+     * it: rootObject() and status() stay those of the previous source until the
+     * new one is loaded, while source() already returns the new one.
+     * Disabling it loads any pending source immediately.
+     *
+     * @param deferred true to defer loading, false by default
+     * @since 5.80
+     */
+    void setLoadingDeferred(bool deferred);
+
+    /**
+     * @return true if loading the source is deferred until the first expose
+     * @since 5.80
+     */
+    bool isLoadingDeferred() const;
+
+    /**
+     * Sets properties that will be set on the root object when created,
+     * before Component.onCompleted gets emitted. It has to be called before
+     * the source gets loaded.
+     *
+     * @param initialProperties the properties of the root object
+     * @since 5.80
+     */
+    void setInitialProperties(const QVariantHash &initialProperties);
+
+    /**
+     * @return the properties set on the root object when created
+     * @since 5.80
+     */
+    QVariantHash initialProperties() const;
+
 protected:
     void resizeEvent(QResizeEvent *e) override;
+    void exposeEvent(QExposeEvent *e) override;
 
 public Q_SLOTS:
     void setSource(const QUrl &url);
 
+    /**
+     * Loads a source whose loading has been deferred with setLoadingDeferred()
+     * without waiting for the window to be exposed.
+     * Does nothing if there is no pending source.
+     * @since 5.80
+     */
+    void preload();
+
 Q_SIGNALS:
     void statusChanged(QQmlComponent::Status status);
     void resizeModeChanged(QuickViewSharedEngine::ResizeMode resizeMode);